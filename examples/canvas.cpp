@@ -0,0 +1,49 @@
+#include <cmath>
+
+#include "Canvas.hpp"
+#include "Color.hpp"
+#include "TUIengine.hpp"
+
+int main() {
+    TUIE::engine &engine = TUIE::engine::instance();
+    engine.set_fps(30);
+
+    // A braille plot on the top half and a half block scene on the bottom half
+    TUIE::Canvas plot(0, 0, TUIE::CanvasMode::BRAILLE);
+    TUIE::Canvas scene(0, 0, TUIE::CanvasMode::HALF_BLOCK);
+    float time = 0;
+    while (!engine.window_should_close()) {
+        engine.begin_draw();
+        TUIE::TerminalSize size = engine.get_terminal_size();
+        const int plot_rows = (size.height - 1) / 2;
+        const int scene_rows = size.height - 1 - plot_rows;
+        if (plot.get_width() != size.width * 2 || plot.get_height() != plot_rows * 4) {
+            plot.resize(size.width, plot_rows);
+            scene.resize(size.width, scene_rows);
+        }
+
+        plot.clear();
+        const int middle = plot.get_height() / 2;
+        plot.draw_line(0, middle, plot.get_width() - 1, middle, TUIE::WHITE);
+        for (int x = 1; x < plot.get_width(); x++) {
+            const auto wave = [&](int x, float speed) {
+                return middle - static_cast<int>(std::sin(x * 0.05f + time * speed) * (middle - 1));
+            };
+            plot.draw_line(x - 1, wave(x - 1, 1), x, wave(x, 1), TUIE::GREEN);
+            plot.draw_line(x - 1, wave(x - 1, -2), x, wave(x, -2), TUIE::CYAN);
+        }
+
+        scene.clear({20, 20, 60});
+        const int ball_x = static_cast<int>((std::sin(time) + 1) / 2 * (scene.get_width() - 8));
+        const int ball_y = static_cast<int>((std::cos(time * 1.3f) + 1) / 2 * (scene.get_height() - 8));
+        scene.fill_rect(ball_x, ball_y, 8, 8, TUIE::RED);
+        scene.fill_rect(0, scene.get_height() - 2, scene.get_width(), 2, TUIE::GREEN);
+
+        plot.draw(engine, 0, 0);
+        scene.draw(engine, 0, plot_rows);
+        engine.draw_rect(0, size.height - 1, size.width, 1, TUIE::WHITE, ' ', TUIE::BLACK);
+        engine.draw_text(0, size.height - 1, " Braille plot and half block scene (Press q to quit)", TUIE::BLACK);
+        engine.end_draw();
+        time += 1.0f / 30;
+    }
+}
@@ -0,0 +1,30 @@
+#include "Color.hpp"
+#include "TUIengine.hpp"
+
+int main() {
+    TUIE::engine &engine = TUIE::engine::instance();
+    engine.set_fps(30);
+    float angle = 0;
+    while (!engine.window_should_close()) {
+        engine.begin_draw();
+        TUIE::TerminalSize size = engine.get_terminal_size();
+        const int half_width = size.width / 2;
+        const int half_height = (size.height - 1) / 2;
+
+        engine.draw_linear_gradient({0, 0, half_width, half_height}, TUIE::BLUE, TUIE::MAGENTA, angle);
+        engine.draw_radial_gradient({half_width, 0, size.width - half_width, half_height}, TUIE::YELLOW,
+                                    TUIE::Color{40, 0, 0});
+        engine.draw_checkerboard({0, half_height, half_width, size.height - 1 - half_height}, TUIE::WHITE,
+                                 TUIE::Color{60, 60, 60});
+        engine.draw_stripes({half_width, half_height, size.width - half_width, size.height - 1 - half_height},
+                            TUIE::GREEN, TUIE::CYAN, 2);
+        // A translucent panel over the four fills
+        engine.shade_rect({size.width / 4, size.height / 4, size.width / 2, size.height / 2}, TUIE::BLACK, 160);
+        engine.draw_text(size.width / 4 + 2, size.height / 4 + 1, "Gradients and patterns", TUIE::WHITE);
+
+        engine.draw_rect(0, size.height - 1, size.width, 1, TUIE::WHITE, ' ', TUIE::BLACK);
+        engine.draw_text(0, size.height - 1, " Fills (Press q to quit)", TUIE::BLACK);
+        engine.end_draw();
+        angle += 3;
+    }
+}
@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "Color.hpp"
+#include "Image.hpp"
+#include "TUIengine.hpp"
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <image.ppm>" << std::endl;
+        return 1;
+    }
+    std::unique_ptr<TUIE::Image> image;
+    try {
+        image = std::make_unique<TUIE::Image>(TUIE::Image::load_ppm(argv[1]));
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    TUIE::engine &engine = TUIE::engine::instance();
+    engine.set_fps(30);
+    TUIE::ImageOptions options;
+    const char *palette_names[] = {"True color", "256 colors", "16 colors"};
+    const char *dither_names[] = {"No dithering", "Ordered", "Floyd-Steinberg"};
+    while (!engine.window_should_close()) {
+        engine.begin_draw();
+        engine.clear_background(TUIE::TERMINAL_COLOR);
+        const TUIE::Input &input = engine.get_input();
+        if (input.is_key_pressed('p')) {
+            options.palette = static_cast<TUIE::Palette>((static_cast<int>(options.palette) + 1) % 3);
+        }
+        if (input.is_key_pressed('d')) {
+            options.dither = static_cast<TUIE::Dither>((static_cast<int>(options.dither) + 1) % 3);
+        }
+
+        // Fit the image keeping its aspect, a cell holds two square pixels stacked
+        TUIE::TerminalSize size = engine.get_terminal_size();
+        const int max_rows = std::max(size.height - 1, 1);
+        int columns = size.width;
+        int rows = (columns * image->get_height() / image->get_width() + 1) / 2;
+        if (rows > max_rows) {
+            rows = max_rows;
+            columns = rows * 2 * image->get_width() / image->get_height();
+        }
+        image->draw(engine, {(size.width - columns) / 2, (max_rows - rows) / 2, columns, rows}, options);
+
+        const std::string status = std::string(" ") + palette_names[static_cast<int>(options.palette)] + ", " +
+                                   dither_names[static_cast<int>(options.dither)] +
+                                   " (Press p for the palette, d for the dithering, q to quit)";
+        engine.draw_rect(0, size.height - 1, size.width, 1, TUIE::WHITE, ' ', TUIE::BLACK);
+        engine.draw_text(0, size.height - 1, status, TUIE::BLACK);
+        engine.end_draw();
+    }
+}
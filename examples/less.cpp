@@ -1,148 +1,135 @@
-#include <algorithm>
-#include <cmath>
-#include <fstream>
+#include <exception>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
-#include <vector>
+#include <string_view>
 
 #include "Color.hpp"
 #include "Input.hpp"
+#include "Pager.hpp"
+#include "RenderTarget.hpp"
 #include "TUIengine.hpp"
 #include "Terminal.hpp"
 
-struct WrappedLine {
-    std::string text;
-    int original_index;
+static constexpr std::string_view help_lines[] = {
+    "j, k, arrows    Scroll one line",
+    "space, b        Scroll one page",
+    "g, G            Go to the top or the bottom",
+    "/               Search",
+    "n, N            Next or previous match",
+    "h               Toggle this help",
+    "q               Quit",
 };
 
-std::vector<WrappedLine> wrap_content(const std::vector<std::string>& raw_lines, int width) {
-    std::vector<WrappedLine> wrapped;
-    if (width < 1) return wrapped;
-
-    for (int i = 0; i < (int)raw_lines.size(); ++i) {
-        const auto& line = raw_lines[i];
-        if (line.empty()) {
-            wrapped.push_back({"", i + 1});
-            continue;
-        }
-
-        for (size_t k = 0; k < line.length(); k += width) {
-            wrapped.push_back({line.substr(k, width), i + 1});
-        }
-    }
-    return wrapped;
-}
-
 int main(int argc, char* argv[]) {
-    // Check if filename is provided
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
+    // Check if filename is provided, -f follows the file as it grows like tail -f
+    const bool follow = argc > 2 && std::string_view(argv[1]) == "-f";
+    if (argc < 2 || (argc > 2 && !follow)) {
+        std::cerr << "Usage: " << argv[0] << " [-f] <filename>" << std::endl;
         return 1;
     }
-
-    // Read file content
-    std::vector<std::string> lines;
-    std::ifstream file(argv[1]);
-    if (!file.is_open()) {
-        std::cerr << "Could not open file: " << argv[1] << std::endl;
+    const char* filename = argv[argc - 1];
+
+    // Open the file before the engine takes the terminal, so the errors are visible
+    std::unique_ptr<TUIE::Pager> pager;
+    try {
+        pager = std::make_unique<TUIE::Pager>(filename);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
         return 1;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        lines.push_back(line);
-    }
-    file.close();
-
     // Initialize engine
     TUIE::engine& engine = TUIE::engine::instance();
     engine.set_fps(60);
+    if (follow) {
+        pager->follow(engine);
+    }
 
-    int scroll_offset = 0;
-    std::vector<WrappedLine> display_lines;
-    int last_terminal_width = 0;
+    // While typing a search query the keys go to the query instead of the pager
+    bool typing_query = false;
+    std::string query;
+    // The help never changes, so it is rendered once and then copied every frame
+    bool show_help = false;
+    TUIE::RenderTarget help;
 
-    while (!engine.window_should_close()) {
+    while (true) {
         engine.begin_draw();
         engine.clear_background(TUIE::TERMINAL_COLOR);
+        TUIE::Input& input = engine.get_input();
 
         TUIE::TerminalSize size = engine.get_terminal_size();
         int content_height = size.height - 1;
         if (content_height < 1) content_height = 1;
 
-        // Recalculate wrapping if width changed
-        if (size.width != last_terminal_width) {
-            display_lines = wrap_content(lines, size.width);
-            last_terminal_width = size.width;
-
-            // Adjust scroll if out of bounds
-            if (scroll_offset >= (int)display_lines.size()) {
-                scroll_offset = std::max(0, (int)display_lines.size() - content_height);
-            }
-        }
-
-        int total_display_lines = (int)display_lines.size();
-        int max_scroll = std::max(0, total_display_lines - content_height);
-
         // Input Handling
-        // Down
-        if (engine.get_input().is_key_pressed(TUIE::KEYS::DOWN) || engine.get_input().is_key_pressed('j') ||
-            engine.get_input().is_scroll_down()) {
-            if (scroll_offset < max_scroll) {
-                scroll_offset++;
-            }
-        }
-        // Up
-        if (engine.get_input().is_key_pressed(TUIE::KEYS::UP) || engine.get_input().is_key_pressed('k') ||
-            engine.get_input().is_scroll_up()) {
-            if (scroll_offset > 0) {
-                scroll_offset--;
-            }
-        }
-        // Page Down
-        if (engine.get_input().is_key_pressed(TUIE::KEYS::PAGE_DOWN) ||
-            engine.get_input().is_key_pressed(TUIE::KEYS::SPACE)) {
-            if (scroll_offset < max_scroll) {
-                scroll_offset += content_height;
-                if (scroll_offset > max_scroll) scroll_offset = max_scroll;
-            }
-        }
-        // Page Up
-        if (engine.get_input().is_key_pressed(TUIE::KEYS::PAGE_UP) || engine.get_input().is_key_pressed('b')) {
-            scroll_offset -= content_height;
-            if (scroll_offset < 0) {
-                scroll_offset = 0;
+        pager->set_viewport(size.width, content_height);
+        if (typing_query) {
+            for (const TUIE::InputEvent& event : input.get_events()) {
+                if (event.type != TUIE::InputEvent::type_t::Keyboard) continue;
+                const TUIE::KeyboardEvent& key = event.as.keyboardEvent;
+                if (key.key == TUIE::KEYS::CHARACTER) {
+                    query += key.character;
+                } else if (key.key == TUIE::KEYS::SPACE) {
+                    query += ' ';
+                } else if (key.key == TUIE::KEYS::BACKSPACE || key.key == TUIE::KEYS::DELETE) {
+                    if (!query.empty()) query.pop_back();
+                } else if (key.key == TUIE::KEYS::ENTER) {
+                    pager->search(query);
+                    typing_query = false;
+                } else if (key.key == TUIE::KEYS::ESCAPE) {
+                    typing_query = false;
+                }
             }
-        }
-        // Home
-        if (engine.get_input().is_key_pressed(TUIE::KEYS::HOME) || engine.get_input().is_key_pressed('g')) {
-            scroll_offset = 0;
-        }
-        // End
-        if (engine.get_input().is_key_pressed(TUIE::KEYS::END) || engine.get_input().is_key_pressed('G')) {
-            scroll_offset = max_scroll;
+        } else if (input.is_key_pressed('/')) {
+            typing_query = true;
+            query.clear();
+        } else if (input.is_key_pressed('h')) {
+            show_help = !show_help;
+        } else if (engine.window_should_close()) {
+            break;
+        } else {
+            pager->handle_input(input);
         }
 
         // Render content
-        for (int i = 0; i < content_height; ++i) {
-            int line_index = scroll_offset + i;
-            if (line_index >= 0 && line_index < total_display_lines) {
-                engine.draw_text(0, i, display_lines[line_index].text, TUIE::WHITE);
-            }
+        pager->draw(engine, 0, 0, TUIE::WHITE);
+
+        if (show_help) {
+            const int help_width = 50;
+            const int help_height = std::size(help_lines) + 2;
+            help.draw(engine, (size.width - help_width) / 2, (content_height - help_height) / 2, help_width,
+                      help_height, 0, [&]() {
+                          engine.draw_rect(0, 0, help_width, help_height, TUIE::BLUE);
+                          for (size_t i = 0; i < std::size(help_lines); i++) {
+                              engine.draw_text(2, i + 1, help_lines[i], TUIE::WHITE);
+                          }
+                      });
         }
 
         // Render Status Bar
         std::ostringstream ss;
-        ss << " " << argv[1] << " ";
-        if (lines.empty()) {
-            ss << "(Empty file) ";
+        if (typing_query) {
+            ss << "/" << query;
         } else {
-            int start_line = display_lines[scroll_offset].original_index;
-            int end_idx = std::min(scroll_offset + content_height - 1, total_display_lines - 1);
-            int end_line = display_lines[end_idx].original_index;
-            ss << "Lines " << (start_line) << "-" << (end_line) << "/" << (lines.size());
+            ss << " " << filename << " ";
+            if (pager->get_line_count() == 0) {
+                ss << (pager->is_indexing() ? "(Loading) " : "(Empty file) ");
+            } else {
+                ss << "Lines " << (pager->get_first_visible_line() + 1) << "-" << (pager->get_last_visible_line() + 1)
+                   << "/" << pager->get_line_count() << (pager->is_indexing() ? "+" : "");
+            }
+            if (pager->is_following()) {
+                ss << " (Following)";
+            }
+            const TUIE::Search& search = pager->get_search();
+            if (!search.get_query().empty()) {
+                ss << " /" << search.get_query() << ": " << search.match_count()
+                   << (search.is_truncated() ? "+" : "") << " matches" << (search.is_complete() ? "" : "...");
+            }
+            ss << " (Press h for help, q to quit)";
         }
-        ss << " (Press q to quit)";
 
         // Draw white bar at bottom
         engine.draw_rect(0, size.height - 1, size.width, 1, TUIE::WHITE, ' ', TUIE::BLACK);
@@ -153,4 +140,4 @@ int main(int argc, char* argv[]) {
     }
 
     return 0;
-}
\ No newline at end of file
+}
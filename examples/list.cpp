@@ -0,0 +1,41 @@
+#include <string>
+
+#include "Color.hpp"
+#include "ScrollView.hpp"
+#include "TUIengine.hpp"
+
+int main() {
+    TUIE::engine &engine = TUIE::engine::instance();
+    engine.set_fps(60);
+
+    // Ten million rows, every tenth one is a three rows high header
+    const size_t count = 10000000;
+    TUIE::ScrollView view({
+        .count = [&]() { return count; },
+        .render_row =
+            [&](size_t index, TUIE::RowSpan span) {
+                const bool header = index % 10 == 0;
+                const TUIE::Color background = header ? TUIE::BLUE : (index % 2 ? TUIE::TERMINAL_COLOR : TUIE::BLACK);
+                engine.draw_rect(span.x, span.y, span.width, span.height, background);
+                const std::string text = (header ? "Section " : "  Item ") + std::to_string(index);
+                engine.draw_text(span.x, span.y + span.height / 2, text, TUIE::WHITE, background);
+            },
+        .row_height = [](size_t index) { return index % 10 == 0 ? 3 : 1; },
+    });
+
+    while (!engine.window_should_close()) {
+        engine.begin_draw();
+        TUIE::TerminalSize size = engine.get_terminal_size();
+
+        view.set_viewport(0, 0, size.width, size.height - 1);
+        view.handle_input(engine.get_input());
+        view.draw();
+
+        const std::string status = " Rows " + std::to_string(view.get_first_visible()) + "-" +
+                                   std::to_string(view.get_last_visible()) + "/" + std::to_string(view.get_count()) +
+                                   " (Press q to quit)";
+        engine.draw_rect(0, size.height - 1, size.width, 1, TUIE::WHITE, ' ', TUIE::BLACK);
+        engine.draw_text(0, size.height - 1, status, TUIE::BLACK);
+        engine.end_draw();
+    }
+}
@@ -1,48 +1,104 @@
+#include "Animation.hpp"
 #include "Color.hpp"
 #include "TUIengine.hpp"
 #include "Terminal.hpp"
 
 int main() {
     TUIE::engine &engine = TUIE::engine::instance();
-    int x = 0;
-    int y = 0;
-    int dx = 1;
-    int dy = 1;
-    engine.set_fps(60);
+    // The ball moves in fixed steps of 1/60 s, so its speed does not depend on the frame rate (+ and - change it)
+    TUIE::FixedTimestep timestep(std::chrono::microseconds(1000000 / 60));
+    float x = 0, y = 0;
+    float previous_x = 0, previous_y = 0;
+    float dx = 1;
+    float dy = 1;
+    int fps = 60;
+    engine.set_fps(fps);
+    // Flashes yellow on every bounce and fades back to red
+    TUIE::Tween<TUIE::Color> flash(TUIE::YELLOW, TUIE::RED, std::chrono::milliseconds(400), TUIE::Easing::EASE_OUT);
+    int bounces = 0;
+    // Flashes that faded out completely, a bounce during a flash restarts it and cancels its end
+    int flashes = 0;
+    // The ball is drawn into a sprite and blitted every frame, the corners keep the key color so they are skipped
+    TUIE::TerminalBuffer ball(0, 0);
+    TUIE::Color ball_color = TUIE::TERMINAL_COLOR;
     while (!engine.window_should_close()) {
         engine.begin_draw();
+        TUIE::Input &input = engine.get_input();
+        if (input.is_key_pressed('+') && fps < 240) engine.set_fps(fps *= 2);
+        if (input.is_key_pressed('-') && fps > 15) engine.set_fps(fps /= 2);
+        if (input.is_key_pressed('s')) {
+            // Spinning the last millisecond of every wait trades CPU for frames that start on time
+            TUIE::FramePacing pacing = engine.get_frame_pacing();
+            pacing.spin = pacing.spin.count() > 0 ? std::chrono::microseconds(0) : std::chrono::microseconds(1000);
+            engine.set_frame_pacing(pacing);
+        }
         TUIE::TerminalSize size = engine.get_terminal_size();
         int height = size.height / 10;
         int width = height * 2;
+
+        for (int steps = timestep.update(); steps > 0; steps--) {
+            previous_x = x;
+            previous_y = y;
+            x += dx;
+            y += dy;
+            // Logic to permit the ball to bounce off the walls
+            bool bounced = false;
+            if (x > size.width - width) {
+                x = size.width - width;
+                dx = -1;
+                bounced = true;
+            }
+            if (y > size.height - height) {
+                y = size.height - height;
+                dy = -1;
+                bounced = true;
+            }
+            if (x < 0) {
+                x = 0;
+                dx = 1;
+                bounced = true;
+            }
+            if (y < 0) {
+                y = 0;
+                dy = 1;
+                bounced = true;
+            }
+            if (bounced) {
+                bounces++;
+                flash.start(engine.get_timers(), [&flashes] { flashes++; });
+            }
+        }
+
         engine.draw_rect(0, 0, size.width, size.height, TUIE::WHITE, '.');
-        engine.draw_rect(x, y, width, height, TUIE::RED, 'O', TUIE::RED);
+        const TUIE::Color color = flash.value();
+        if (ball.get_height() != height || color != ball_color) {
+            ball_color = color;
+            ball = TUIE::TerminalBuffer(width, height);
+            for (int i = 0; i < height; i++) {
+                for (int j = 0; j < width; j++) {
+                    const float dx = (j + 0.5f) / width * 2 - 1;
+                    const float dy = (i + 0.5f) / height * 2 - 1;
+                    if (dx * dx + dy * dy <= 1) ball.set_cell(j, i, {'O', color, color});
+                }
+            }
+        }
+        // Drawn between the last two steps, so the motion stays smooth when the frames and the steps do not line up
+        const float alpha = timestep.get_alpha();
+        engine.blit(ball, {0, 0, width, height}, TUIE::interpolate(previous_x, x, alpha) + 0.5f,
+                    TUIE::interpolate(previous_y, y, alpha) + 0.5f, TUIE::BlitMode::TRANSPARENT);
         engine.draw_text(
             0, 0,
             "FPS: " + std::to_string(engine.get_target_fps()) + " Real FPS: " + std::to_string(engine.get_real_fps()),
             TUIE::BLACK);
         engine.draw_text(0, 1, "Width: " + std::to_string(size.width), TUIE::BLACK);
         engine.draw_text(0, 2, "Height: " + std::to_string(size.height), TUIE::BLACK);
+        engine.draw_text(0, 3, "Bounces: " + std::to_string(bounces) + " Flashes: " + std::to_string(flashes),
+                         TUIE::BLACK);
+        const TUIE::FrameStats &stats = engine.get_frame_stats();
+        engine.draw_text(0, 4,
+                         "Jitter: " + std::to_string(stats.jitter_ms) + "ms Late: " + std::to_string(stats.max_late_ms) +
+                             "ms Spin (s): " + (engine.get_frame_pacing().spin.count() > 0 ? "on" : "off"),
+                         TUIE::BLACK);
         engine.end_draw();
-
-        x += dx;
-        y += dy;
-
-        // Logic to permit the ball to bounce off the walls
-        if (x > size.width - width) {
-            x = size.width - width;
-            dx = -1;
-        }
-        if (y > size.height - height) {
-            y = size.height - height;
-            dy = -1;
-        }
-        if (x < 0) {
-            x = 0;
-            dx = 1;
-        }
-        if (y < 0) {
-            y = 0;
-            dy = 1;
-        }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,68 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include "Recorder.hpp"
+#include "Renderer.hpp"
+
+// Replays a session recorded with TUIE_RECORD=<file> through the headless renderer as fast as possible, reporting for
+// every frame the render time, the bytes produced and whether the output matches the one recorded.
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <recording> [--quiet]" << std::endl;
+        return 1;
+    }
+    const bool quiet = argc > 2 && std::string_view(argv[2]) == "--quiet";
+
+    try {
+        TUIE::RecordingReader reader(argv[1]);
+        TUIE::RecordedFrame frame;
+
+        int frames = 0;
+        int mismatches = 0;
+        uint64_t total_bytes = 0;
+        uint64_t total_input = 0;
+        std::chrono::nanoseconds total_time{0};
+
+        if (!quiet) {
+            std::cout << "frame\tdelta_us\tinput\tsize\trender_us\tbytes\tresult\n";
+        }
+        while (reader.next_frame(frame)) {
+            TUIE::DigestStream output;
+            const auto start = std::chrono::steady_clock::now();
+            TUIE::Renderer(output, reader.get_palette()).draw(frame.previous_buffer, frame.buffer);
+            const TUIE::FrameDigest digest = output.digest();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            const bool equal = digest == frame.digest;
+            total_time += elapsed;
+            total_bytes += digest.bytes;
+            total_input += frame.input.size();
+            mismatches += equal ? 0 : 1;
+
+            if (!quiet || !equal) {
+                std::cout << frames << '\t' << frame.delta_time_us << '\t' << frame.input.size() << '\t'
+                          << frame.buffer.get_width() << 'x' << frame.buffer.get_height() << '\t' << std::fixed
+                          << std::setprecision(1) << std::chrono::duration<double, std::micro>(elapsed).count()
+                          << '\t' << digest.bytes << '\t';
+                if (equal) {
+                    std::cout << "OK\n";
+                } else {
+                    std::cout << "DIFF (recorded " << frame.digest.bytes << " bytes)\n";
+                }
+            }
+            frames++;
+        }
+
+        const double total_ms = std::chrono::duration<double, std::milli>(total_time).count();
+        std::cout << "Frames: " << frames << " Render time: " << std::fixed << std::setprecision(3) << total_ms
+                  << "ms (" << (frames > 0 ? total_ms * 1000.0 / frames : 0.0) << "us/frame)"
+                  << " Output: " << total_bytes << " bytes Input: " << total_input << " bytes"
+                  << " Mismatches: " << mismatches << std::endl;
+        return mismatches == 0 ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,138 @@
+#include <fcntl.h>
+#include <pty.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Color.hpp"
+#include "SessionHost.hpp"
+#include "TUIengine.hpp"
+
+// Stand-in for the terminals: reads and drops everything the sessions write to their ptys
+class PtyDrain {
+   public:
+    explicit PtyDrain(const std::vector<int> &masters) : m_epoll_fd(epoll_create1(0)) {
+        for (int fd : masters) {
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        }
+        m_thread = std::jthread([this](std::stop_token stop) {
+            char buffer[65536];
+            epoll_event events[64];
+            while (!stop.stop_requested()) {
+                const int count = epoll_wait(m_epoll_fd, events, std::size(events), 50);
+                for (int i = 0; i < count; i++) {
+                    while (read(events[i].data.fd, buffer, sizeof(buffer)) > 0) {
+                    }
+                }
+            }
+        });
+    }
+    ~PtyDrain() {
+        m_thread.request_stop();
+        m_thread.join();
+        close(m_epoll_fd);
+    }
+
+   private:
+    int m_epoll_fd;
+    std::jthread m_thread;
+};
+
+double cpu_seconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// A dashboard like frame: a few counters and a bar that moves every frame
+bool update(TUIE::engine &engine, TUIE::Session &session) {
+    const uint64_t frame = session.get_frame_count();
+    TUIE::TerminalSize size = engine.get_terminal_size();
+    engine.clear_background(TUIE::TERMINAL_COLOR);
+    engine.draw_text(1, 1, "Session " + std::to_string(session.get_id()), TUIE::WHITE);
+    engine.draw_text(1, 2, "Frame " + std::to_string(frame), TUIE::WHITE);
+    for (int i = 0; i < 8; i++) {
+        engine.draw_text(1, 4 + i, "Metric " + std::to_string(i) + ": " + std::to_string((frame * (i + 3)) % 1000),
+                         TUIE::GREEN);
+    }
+    engine.draw_rect(frame % size.width, size.height - 3, 10, 2, TUIE::BLUE);
+    session.request_redraw();
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    const unsigned workers = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    const double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+    const int fps = 30;
+
+    // Every session takes two fds
+    rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    std::cout << "Workers: " << workers << ", target " << fps << " fps, " << seconds << "s per step\n";
+    std::cout << "sessions\tfps/session\tcpu%\tsteals\n";
+    unsigned best = 0;
+    for (unsigned sessions = 8; sessions <= 4096; sessions *= 2) {
+        if (sessions * 2 + 64 > limit.rlim_cur) break;
+        std::vector<int> masters;
+        std::vector<int> slaves;
+        for (unsigned i = 0; i < sessions; i++) {
+            int master, slave;
+            winsize size = {24, 80, 0, 0};
+            if (openpty(&master, &slave, nullptr, nullptr, &size) != 0) {
+                std::perror("openpty");
+                break;
+            }
+            fcntl(master, F_SETFL, O_NONBLOCK);
+            masters.push_back(master);
+            slaves.push_back(slave);
+        }
+        if (masters.size() != sessions) break;
+
+        double fps_per_session;
+        double cpu;
+        uint64_t steals;
+        {
+            PtyDrain drain(masters);
+            TUIE::SessionHost host(workers, fps);
+            for (int slave : slaves) {
+                host.add_session(slave, slave, update);
+            }
+            // Let the first frames settle before measuring
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            const auto start_stats = host.get_stats();
+            const double start_cpu = cpu_seconds();
+            const auto start = std::chrono::steady_clock::now();
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            const auto stats = host.get_stats();
+            fps_per_session = (stats.frames - start_stats.frames) / elapsed / sessions;
+            cpu = (cpu_seconds() - start_cpu) / elapsed;
+            steals = stats.steals - start_stats.steals;
+        }
+        for (unsigned i = 0; i < sessions; i++) {
+            close(masters[i]);
+            close(slaves[i]);
+        }
+
+        std::printf("%u\t\t%.1f\t\t%.0f\t%lu\n", sessions, fps_per_session, cpu * 100, steals);
+        std::fflush(stdout);
+        if (fps_per_session < fps * 0.95) break;
+        best = sessions;
+    }
+    std::printf("Sessions per core at %d fps: %.1f\n", fps, static_cast<double>(best) / workers);
+}
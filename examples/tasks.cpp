@@ -0,0 +1,81 @@
+#include <chrono>
+#include <random>
+#include <string>
+
+#include "Color.hpp"
+#include "TUIengine.hpp"
+
+using namespace std::chrono_literals;
+
+// Every spark is its own task, so its state lives in local variables instead of a struct updated every frame
+TUIE::Task spark(TUIE::engine &engine, unsigned seed) {
+    std::minstd_rand random(seed);
+    const TUIE::Color colors[] = {TUIE::RED, TUIE::GREEN, TUIE::YELLOW, TUIE::BLUE, TUIE::MAGENTA, TUIE::CYAN};
+    int x = -1;
+    int y = -1;
+    while (true) {
+        const TUIE::TerminalSize size = engine.get_terminal_size();
+        if (x >= 0 && x < size.width && y >= 2 && y < size.height) {
+            engine.draw_rect(x, y, 1, 1, TUIE::TERMINAL_COLOR);
+        }
+        x = random() % std::max(size.width, 1);
+        y = 2 + random() % std::max(size.height - 2, 1);
+        engine.draw_text(x, y, "*", colors[random() % std::size(colors)]);
+        co_await TUIE::sleep(std::chrono::milliseconds(100 + random() % 900));
+    }
+}
+
+// A step of a longer interaction, awaited by the task that needs it
+TUIE::Task flash(TUIE::engine &engine, std::string text) {
+    for (int i = 0; i < 6; i++) {
+        engine.draw_rect(0, 1, engine.get_terminal_size().width, 1, i % 2 ? TUIE::TERMINAL_COLOR : TUIE::BLUE);
+        engine.draw_text(0, 1, text, TUIE::WHITE);
+        co_await TUIE::sleep(150ms);
+    }
+}
+
+TUIE::Task typing(TUIE::engine &engine) {
+    std::string line;
+    while (true) {
+        const TUIE::KeyboardEvent key = co_await engine.get_input().key();
+        if (key.key == TUIE::KEYS::ENTER) {
+            co_await flash(engine, "Sent: " + line);
+            line.clear();
+        } else if (key.key == TUIE::KEYS::BACKSPACE && !line.empty()) {
+            line.pop_back();
+        } else if (key.key == TUIE::KEYS::CHARACTER) {
+            line += key.character;
+        } else if (key.key == TUIE::KEYS::SPACE) {
+            line += ' ';
+        }
+        engine.draw_rect(0, 1, engine.get_terminal_size().width, 1, TUIE::TERMINAL_COLOR);
+        engine.draw_text(0, 1, "> " + line, TUIE::WHITE);
+    }
+}
+
+TUIE::Task status(TUIE::engine &engine, int sparks) {
+    while (true) {
+        const TUIE::TerminalSize size = engine.get_terminal_size();
+        const std::string text = " " + std::to_string(sparks) + " spark tasks, Real FPS: " +
+                                 std::to_string(static_cast<int>(engine.get_real_fps())) +
+                                 " (Type and press enter, q to quit)";
+        engine.draw_rect(0, 0, size.width, 1, TUIE::WHITE, ' ', TUIE::BLACK);
+        engine.draw_text(0, 0, text, TUIE::BLACK);
+        co_await engine.next_frame();
+    }
+}
+
+int main() {
+    TUIE::engine &engine = TUIE::engine::instance();
+    engine.set_fps(60);
+    // Shifted keys type their own character and ESC is told apart without waiting, on terminals that support it
+    engine.enable_kitty_keyboard(true);
+
+    const int sparks = 500;
+    engine.spawn(status(engine, sparks));
+    engine.spawn(typing(engine));
+    for (int i = 0; i < sparks; i++) {
+        engine.spawn(spark(engine, i + 1));
+    }
+    engine.run();
+}
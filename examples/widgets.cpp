@@ -0,0 +1,52 @@
+#include <ctime>
+#include <string>
+
+#include "Color.hpp"
+#include "TUIengine.hpp"
+#include "Widget.hpp"
+
+int main() {
+    TUIE::engine &engine = TUIE::engine::instance();
+    engine.set_fps(30);
+
+    // The tree is retained: only the clock and the counter are painted again each frame
+    TUIE::WidgetTree tree;
+    auto &header = tree.root().add<TUIE::Text>(" Widgets (Press q to quit, space to count, b to toggle the border)");
+    header.set_fixed_size(1).set_background(TUIE::BLUE);
+
+    auto &body = tree.root().add<TUIE::Row>();
+    auto &sidebar = body.add<TUIE::Box>("Menu");
+    sidebar.set_fixed_size(20);
+    sidebar.add<TUIE::Text>("Files\nEdit\nView\nHelp");
+
+    auto &main = body.add<TUIE::Box>("Main");
+    auto &counter = main.add<TUIE::Text>("Count 0");
+    counter.set_fixed_size(1);
+    main.add<TUIE::Text>("Flexible area").set_flex(2);
+    main.add<TUIE::Text>("Half of it").set_flex(1).set_background(TUIE::BLACK);
+
+    auto &clock = tree.root().add<TUIE::Text>();
+    clock.set_fixed_size(1).set_background(TUIE::WHITE).set_foreground(TUIE::BLACK);
+
+    int count = 0;
+    bool border = true;
+    while (!engine.window_should_close()) {
+        engine.begin_draw();
+        const TUIE::Input &input = engine.get_input();
+        if (input.is_key_pressed(TUIE::KEYS::SPACE)) {
+            counter.set_text("Count " + std::to_string(++count));
+        }
+        if (input.is_key_pressed('b')) {
+            border = !border;
+            main.set_border(border);
+        }
+
+        char time[32];
+        const std::time_t now = std::time(nullptr);
+        std::strftime(time, sizeof(time), " %H:%M:%S", std::localtime(&now));
+        clock.set_text(time);
+
+        tree.render(engine);
+        engine.end_draw();
+    }
+}
@@ -0,0 +1,71 @@
+#include "Animation.hpp"
+
+#include <cmath>
+
+namespace TUIE {
+
+int FixedTimestep::update(Clock::time_point now) {
+    if (!m_started) {
+        m_started = true;
+        m_last = now;
+        return 0;
+    }
+    m_accumulator += now - m_last;
+    m_last = now;
+    int steps = 0;
+    while (m_accumulator >= m_step) {
+        m_accumulator -= m_step;
+        if (++steps == m_max_steps) {
+            m_accumulator = std::min(m_accumulator, m_step - Clock::duration(1));
+            break;
+        }
+    }
+    return steps;
+}
+
+float ease(Easing easing, float t) {
+    t = std::clamp(t, 0.0f, 1.0f);
+    switch (easing) {
+        case Easing::LINEAR:
+            return t;
+        case Easing::EASE_IN:
+            return t * t * t;
+        case Easing::EASE_OUT: {
+            const float inverse = 1 - t;
+            return 1 - inverse * inverse * inverse;
+        }
+        case Easing::EASE_IN_OUT:
+            return t < 0.5f ? 4 * t * t * t : 1 - std::pow(-2 * t + 2, 3.0f) / 2;
+        case Easing::BOUNCE: {
+            // Piecewise parabolas of the classic bounce out curve
+            constexpr float n = 7.5625f;
+            constexpr float d = 2.75f;
+            if (t < 1 / d) return n * t * t;
+            if (t < 2 / d) {
+                t -= 1.5f / d;
+                return n * t * t + 0.75f;
+            }
+            if (t < 2.5f / d) {
+                t -= 2.25f / d;
+                return n * t * t + 0.9375f;
+            }
+            t -= 2.625f / d;
+            return n * t * t + 0.984375f;
+        }
+    }
+    return t;
+}
+
+float interpolate(float from, float to, float t) { return from + (to - from) * t; }
+
+int interpolate(int from, int to, float t) { return static_cast<int>(std::lround(from + (to - from) * t)); }
+
+Color interpolate(Color from, Color to, float t) {
+    if (from.without_color || to.without_color) return t < 1 ? from : to;
+    const auto channel = [t](uint8_t from, uint8_t to) {
+        return static_cast<uint8_t>(std::clamp(std::lround(from + (to - from) * t), 0L, 255L));
+    };
+    return {channel(from.r, to.r), channel(from.g, to.g), channel(from.b, to.b)};
+}
+
+}  // namespace TUIE
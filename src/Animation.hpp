@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <utility>
+
+#include "Color.hpp"
+#include "TimerWheel.hpp"
+
+namespace TUIE {
+
+// Runs the simulation in steps of a fixed duration whatever the frame rate: every frame runs the steps for the time
+// that passed and draws the state interpolated by get_alpha between the previous and the last step
+class FixedTimestep {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FixedTimestep(Clock::duration step, int max_steps = 5) : m_step(step), m_max_steps(max_steps) {}
+
+   public:
+    // Number of steps to run now. After a stall the time beyond max_steps is dropped, so the simulation slows down
+    // instead of spending the next frames catching up.
+    int update(Clock::time_point now = Clock::now());
+    // Fraction of a step between the last step and now, from 0 to 1
+    float get_alpha() const { return std::chrono::duration<float>(m_accumulator) / m_step; }
+    Clock::duration get_step() const { return m_step; }
+    float get_step_seconds() const { return std::chrono::duration<float>(m_step).count(); }
+
+   private:
+    Clock::duration m_step;
+    int m_max_steps;
+    Clock::duration m_accumulator{0};
+    Clock::time_point m_last;
+    bool m_started = false;
+};
+
+enum class Easing { LINEAR, EASE_IN, EASE_OUT, EASE_IN_OUT, BOUNCE };
+
+// Maps the progress t, from 0 to 1, to the progress of the value
+float ease(Easing easing, float t);
+
+float interpolate(float from, float to, float t);
+// Rounded to the nearest cell
+int interpolate(int from, int to, float t);
+// Per channel, a color without color (TERMINAL_COLOR) switches to the other one at the end
+Color interpolate(Color from, Color to, float t);
+
+// Value that goes from `from` to `to` during `duration` once started, T needs an interpolate overload
+template <typename T>
+class Tween {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    Tween(T from, T to, Clock::duration duration, Easing easing = Easing::EASE_IN_OUT)
+        : m_from(from), m_to(to), m_duration(duration), m_easing(easing) {}
+    ~Tween() { cancel_finished(); }
+    // The pending on_finished timer belongs to one tween, so it moves with it and is never copied
+    Tween(const Tween&) = delete;
+    Tween& operator=(const Tween&) = delete;
+    Tween(Tween&& other) noexcept
+        : m_from(std::move(other.m_from)),
+          m_to(std::move(other.m_to)),
+          m_duration(other.m_duration),
+          m_easing(other.m_easing),
+          m_start(other.m_start),
+          m_timers(std::exchange(other.m_timers, nullptr)),
+          m_finished(std::exchange(other.m_finished, std::nullopt)) {}
+    Tween& operator=(Tween&& other) noexcept {
+        if (this != &other) {
+            cancel_finished();
+            m_from = std::move(other.m_from);
+            m_to = std::move(other.m_to);
+            m_duration = other.m_duration;
+            m_easing = other.m_easing;
+            m_start = other.m_start;
+            m_timers = std::exchange(other.m_timers, nullptr);
+            m_finished = std::exchange(other.m_finished, std::nullopt);
+        }
+        return *this;
+    }
+
+   public:
+    // Starting again before the end restarts from `from`, the on_finished of the previous start does not run
+    void start(Clock::time_point now = Clock::now()) {
+        cancel_finished();
+        m_start = now;
+    }
+    // The callback runs from the timers of the wheel when the tween ends. The wheel must outlive the tween.
+    void start(TimerWheel& timers, TimerWheel::Callback on_finished, Clock::time_point now = Clock::now()) {
+        start(now);
+        m_timers = &timers;
+        m_finished = timers.schedule_at(now + m_duration, {}, std::move(on_finished));
+    }
+    // Back to not started, the value is `from` again and the pending on_finished does not run
+    void stop() {
+        cancel_finished();
+        m_start = {};
+    }
+    void set_target(T from, T to) {
+        m_from = from;
+        m_to = to;
+    }
+    // Before it is started the value is `from`
+    T value(Clock::time_point now = Clock::now()) const {
+        return interpolate(m_from, m_to, ease(m_easing, progress(now)));
+    }
+    bool is_finished(Clock::time_point now = Clock::now()) const { return progress(now) >= 1; }
+
+   private:
+    void cancel_finished() {
+        if (m_timers && m_finished) {
+            m_timers->cancel(*m_finished);
+        }
+        m_timers = nullptr;
+        m_finished.reset();
+    }
+    float progress(Clock::time_point now) const {
+        if (m_start == Clock::time_point() || now <= m_start) return 0;
+        if (m_duration <= Clock::duration(0)) return 1;
+        return std::min(std::chrono::duration<float>(now - m_start) / m_duration, 1.0f);
+    }
+
+   private:
+    T m_from;
+    T m_to;
+    Clock::duration m_duration;
+    Easing m_easing;
+    Clock::time_point m_start{};
+    TimerWheel* m_timers = nullptr;
+    std::optional<TimerWheel::TimerId> m_finished;
+};
+
+}  // namespace TUIE
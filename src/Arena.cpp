@@ -0,0 +1,31 @@
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace TUIE {
+
+char *Arena::allocate(size_t size) {
+    // Move forward through the already allocated blocks until one has room, only allocating when none is left
+    while (m_block < m_blocks.size() && m_offset + size > m_blocks[m_block].size) {
+        m_block++;
+        m_offset = 0;
+    }
+    if (m_block == m_blocks.size()) {
+        const size_t block_size = std::max(m_block_size, size);
+        m_blocks.push_back({std::make_unique<char[]>(block_size), block_size});
+        m_offset = 0;
+    }
+    char *ptr = m_blocks[m_block].data.get() + m_offset;
+    m_offset += size;
+    return ptr;
+}
+
+std::string_view Arena::store(std::string_view sv) {
+    if (sv.empty()) return {};
+    char *ptr = allocate(sv.size());
+    std::memcpy(ptr, sv.data(), sv.size());
+    return std::string_view(ptr, sv.size());
+}
+
+}  // namespace TUIE
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace TUIE {
+
+// Bump allocator for data that lives for a single frame. Everything is released at once with reset(), and the blocks
+// are kept for the next frame, so once it has grown to the working size it no longer touches the heap.
+class Arena {
+   public:
+    explicit Arena(size_t block_size = 4096) : m_block_size(block_size) {}
+
+   public:
+    char *allocate(size_t size);
+    // Copies the string into the arena, the view is valid until the next reset()
+    std::string_view store(std::string_view sv);
+    void reset() {
+        m_block = 0;
+        m_offset = 0;
+    }
+
+   private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_block_size;
+    size_t m_block = 0;
+    size_t m_offset = 0;
+};
+
+}  // namespace TUIE
@@ -0,0 +1,185 @@
+#include "Canvas.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <stdexcept>
+
+#include "TUIengine.hpp"
+
+namespace TUIE {
+
+namespace {
+
+// Colors are four bytes, comparing them as integers keeps the packing loops free of branches
+bool is_on(Color color) { return std::bit_cast<uint32_t>(color) != std::bit_cast<uint32_t>(TERMINAL_COLOR); }
+
+// Braille bit of the dot in the column and row of a cell
+constexpr uint8_t BRAILLE_BITS[4][2] = {{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+
+}  // namespace
+
+Canvas::Canvas(int columns, int rows, CanvasMode mode)
+    : m_mode(mode),
+      m_cell_width(mode == CanvasMode::BRAILLE ? 2 : 1),
+      m_cell_height(mode == CanvasMode::BRAILLE ? 4 : 2),
+      m_width(0),
+      m_height(0),
+      m_cells(0, 0) {
+    resize(columns, rows);
+}
+
+void Canvas::resize(int columns, int rows) {
+    if (columns < 0 || rows < 0) {
+        throw std::invalid_argument("Canvas size can not be negative");
+    }
+    m_width = columns * m_cell_width;
+    m_height = rows * m_cell_height;
+    m_pixels.assign(m_width * m_height, TERMINAL_COLOR);
+    m_cells = TerminalBuffer(columns, rows);
+    m_dirty.assign(rows, {0, 0});
+}
+
+void Canvas::clear(Color color) { fill_rect(0, 0, m_width, m_height, color); }
+
+void Canvas::set_pixel(int x, int y, Color color) {
+    if (x < 0 || x >= m_width || y < 0 || y >= m_height) return;
+    m_pixels[y * m_width + x] = color;
+    mark_dirty(x, y, 1, 1);
+}
+
+Color Canvas::get_pixel(int x, int y) const {
+    if (x < 0 || x >= m_width || y < 0 || y >= m_height) {
+        throw std::out_of_range("x or y is out of bounds");
+    }
+    return m_pixels[y * m_width + x];
+}
+
+void Canvas::draw_line(int x0, int y0, int x1, int y1, Color color) {
+    // Bresenham, the pixels outside of the canvas are skipped by set_pixel
+    const int dx = std::abs(x1 - x0);
+    const int dy = -std::abs(y1 - y0);
+    const int step_x = x0 < x1 ? 1 : -1;
+    const int step_y = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+    while (true) {
+        set_pixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        const int error2 = 2 * error;
+        if (error2 >= dy) {
+            error += dy;
+            x0 += step_x;
+        }
+        if (error2 <= dx) {
+            error += dx;
+            y0 += step_y;
+        }
+    }
+}
+
+void Canvas::fill_rect(int x, int y, int width, int height, Color color) {
+    const int left = std::max(x, 0);
+    const int top = std::max(y, 0);
+    const int right = std::min(x + width, m_width);
+    const int bottom = std::min(y + height, m_height);
+    if (left >= right || top >= bottom) return;
+    for (int i = top; i < bottom; i++) {
+        std::fill(m_pixels.begin() + i * m_width + left, m_pixels.begin() + i * m_width + right, color);
+    }
+    mark_dirty(left, top, right - left, bottom - top);
+}
+
+void Canvas::blit(const Canvas& source, Rect source_rect, int x, int y) {
+    // Clip to the source and then to this canvas, moving the other corner along
+    const int left = std::max({source_rect.x, 0, source_rect.x - x});
+    const int top = std::max({source_rect.y, 0, source_rect.y - y});
+    const int right = std::min({source_rect.x + source_rect.width, source.m_width, source_rect.x + m_width - x});
+    const int bottom = std::min({source_rect.y + source_rect.height, source.m_height, source_rect.y + m_height - y});
+    if (left >= right || top >= bottom) return;
+    const int to_x = x + left - source_rect.x;
+    const int to_y = y + top - source_rect.y;
+    for (int i = 0; i < bottom - top; i++) {
+        std::copy_n(source.m_pixels.begin() + (top + i) * source.m_width + left, right - left,
+                    m_pixels.begin() + (to_y + i) * m_width + to_x);
+    }
+    mark_dirty(to_x, to_y, right - left, bottom - top);
+}
+
+void Canvas::draw(engine& engine, int x, int y) {
+    pack();
+    engine.blit(m_cells, {0, 0, m_cells.get_width(), m_cells.get_height()}, x, y);
+}
+
+void Canvas::mark_dirty(int x, int y, int width, int height) {
+    const int begin = x / m_cell_width;
+    const int end = (x + width - 1) / m_cell_width + 1;
+    for (int row = y / m_cell_height; row <= (y + height - 1) / m_cell_height; row++) {
+        DirtySpan& span = m_dirty[row];
+        if (span.begin >= span.end) {
+            span = {begin, end};
+        } else {
+            span = {std::min(span.begin, begin), std::max(span.end, end)};
+        }
+    }
+}
+
+void Canvas::pack() {
+    for (int row = 0; row < static_cast<int>(m_dirty.size()); row++) {
+        DirtySpan& span = m_dirty[row];
+        if (span.begin >= span.end) continue;
+        if (m_mode == CanvasMode::HALF_BLOCK) {
+            pack_half_block(row, span.begin, span.end);
+        } else {
+            pack_braille(row, span.begin, span.end);
+        }
+        span = {0, 0};
+    }
+}
+
+void Canvas::pack_half_block(int row, int begin, int end) {
+    const Color* top = m_pixels.data() + row * 2 * m_width;
+    const Color* bottom = top + m_width;
+    std::span<TerminalCell> cells = m_cells.cells().subspan(row * m_cells.get_width());
+    for (int x = begin; x < end; x++) {
+        // The upper half block carries the top pixel as foreground, unless only the bottom one is on, then the lower
+        // half block keeps the background of the terminal
+        const bool top_on = is_on(top[x]);
+        const bool bottom_on = is_on(bottom[x]);
+        if (top[x] == bottom[x]) {
+            cells[x] = {U' ', top[x], top[x]};
+        } else if (!top_on) {
+            cells[x] = {U'▄', bottom[x], TERMINAL_COLOR};
+        } else {
+            cells[x] = {U'▀', top[x], bottom_on ? bottom[x] : TERMINAL_COLOR};
+        }
+    }
+}
+
+void Canvas::pack_braille(int row, int begin, int end) {
+    // The dots are gathered a whole pixel row at a time, so every inner loop walks contiguous memory
+    std::vector<uint8_t>& bits = m_braille_bits;
+    std::vector<Color>& colors = m_braille_colors;
+    bits.assign(end - begin, 0);
+    colors.assign(end - begin, TERMINAL_COLOR);
+    for (int dot_row = 3; dot_row >= 0; dot_row--) {
+        const Color* pixels = m_pixels.data() + (row * 4 + dot_row) * m_width;
+        for (int x = begin; x < end; x++) {
+            const Color left = pixels[x * 2];
+            const Color right = pixels[x * 2 + 1];
+            const bool left_on = is_on(left);
+            const bool right_on = is_on(right);
+            bits[x - begin] |= (left_on ? BRAILLE_BITS[dot_row][0] : 0) | (right_on ? BRAILLE_BITS[dot_row][1] : 0);
+            // The topmost dot decides the color of the cell
+            colors[x - begin] = left_on ? left : (right_on ? right : colors[x - begin]);
+        }
+    }
+    std::span<TerminalCell> cells = m_cells.cells().subspan(row * m_cells.get_width());
+    for (int x = begin; x < end; x++) {
+        const uint8_t dots = bits[x - begin];
+        cells[x] = {dots ? static_cast<char32_t>(0x2800 + dots) : U' ', colors[x - begin], TERMINAL_COLOR};
+    }
+}
+
+}  // namespace TUIE
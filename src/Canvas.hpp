@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Color.hpp"
+#include "Rect.hpp"
+#include "TerminalBuffer.hpp"
+
+namespace TUIE {
+
+class engine;
+
+enum class CanvasMode {
+    // Two pixels per cell stacked vertically, each one with its own color
+    HALF_BLOCK,
+    // Two by four dots per cell, all the dots of a cell share one color
+    BRAILLE,
+};
+
+// Pixel framebuffer with more resolution than one pixel per cell. A pixel with TERMINAL_COLOR is off. The pixels are
+// packed into cells when drawn, and only the cells touched since the previous draw are packed again.
+class Canvas {
+   public:
+    // The size is in cells, the pixel size depends on the mode
+    Canvas(int columns, int rows, CanvasMode mode);
+
+   public:
+    void resize(int columns, int rows);
+    int get_width() const { return m_width; }
+    int get_height() const { return m_height; }
+    CanvasMode get_mode() const { return m_mode; }
+
+    void clear(Color color = TERMINAL_COLOR);
+    void set_pixel(int x, int y, Color color);
+    Color get_pixel(int x, int y) const;
+    void draw_line(int x0, int y0, int x1, int y1, Color color);
+    void fill_rect(int x, int y, int width, int height, Color color);
+    // Copies the source_rect pixels of source to x, y, clipped to both canvases
+    void blit(const Canvas& source, Rect source_rect, int x, int y);
+    void draw(engine& engine, int x, int y);
+
+   private:
+    void mark_dirty(int x, int y, int width, int height);
+    void pack();
+    void pack_half_block(int row, int begin, int end);
+    void pack_braille(int row, int begin, int end);
+
+   private:
+    CanvasMode m_mode;
+    int m_cell_width;
+    int m_cell_height;
+    int m_width;
+    int m_height;
+    std::vector<Color> m_pixels;
+    TerminalBuffer m_cells;
+
+    // Columns of cells to pack again for every row of cells, empty when begin >= end
+    struct DirtySpan {
+        int begin;
+        int end;
+    };
+    std::vector<DirtySpan> m_dirty;
+    // Scratch space of pack_braille, kept to not allocate on every draw
+    std::vector<uint8_t> m_braille_bits;
+    std::vector<Color> m_braille_colors;
+};
+
+}  // namespace TUIE
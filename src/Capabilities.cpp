@@ -0,0 +1,152 @@
+#include "Capabilities.hpp"
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+namespace TUIE {
+
+namespace {
+
+constexpr int BRACKETED_PASTE_MODE = 2004;
+constexpr int SGR_MOUSE_MODE = 1006;
+
+std::string_view get_env(const char* name) {
+    const char* value = std::getenv(name);
+    return value ? value : "";
+}
+
+}  // namespace
+
+CapabilityProbe::CapabilityProbe(bool use_cache) : m_use_cache(use_cache) {
+    if (!use_cache) return;
+
+    // The guess until the probe answers, an unknown TERM keeps true color as the engine always had
+    const std::string_view term = get_env("TERM");
+    const std::string_view colorterm = get_env("COLORTERM");
+    if (colorterm == "truecolor" || colorterm == "24bit" || term.empty() || term.ends_with("-direct")) {
+        m_capabilities.palette = Palette::TRUE_COLOR;
+    } else if (term == "linux" || term == "dumb" || term == "ansi" || term.starts_with("vt")) {
+        m_capabilities.palette = Palette::COLORS_16;
+    } else {
+        m_capabilities.palette = Palette::COLORS_256;
+    }
+
+    m_cache_key.append(term).append("|").append(get_env("TERM_PROGRAM")).append("|");
+    m_cache_key.append(get_env("TERM_PROGRAM_VERSION"));
+    m_complete = load_cache();
+}
+
+void CapabilityProbe::start(Terminal& terminal) {
+    if (m_complete) return;
+    terminal.request_mode(SYNCHRONIZED_OUTPUT_MODE);
+    terminal.request_mode(BRACKETED_PASTE_MODE);
+    terminal.request_mode(SGR_MOUSE_MODE);
+    terminal.request_keyboard_flags();
+    terminal.request_capability("RGB");
+    terminal.request_capability("Tc");
+    // Terminals answer in order, so this one arrives last
+    terminal.request_device_attributes();
+}
+
+bool CapabilityProbe::on_report(const TerminalReport& report) {
+    const Capabilities before = m_capabilities;
+    switch (report.type) {
+        case TerminalReport::type_t::Mode: {
+            const bool known = report.value >= 1 && report.value <= 3;
+            if (report.mode == SYNCHRONIZED_OUTPUT_MODE) {
+                m_capabilities.synchronized_output = known;
+            } else if (report.mode == BRACKETED_PASTE_MODE) {
+                m_capabilities.bracketed_paste = known;
+            } else if (report.mode == SGR_MOUSE_MODE) {
+                m_capabilities.sgr_mouse = known;
+            }
+            break;
+        }
+        case TerminalReport::type_t::KeyboardFlags:
+            m_capabilities.kitty_keyboard = true;
+            break;
+        case TerminalReport::type_t::Capability:
+            if (report.value && (report.mode == capability_id("RGB") || report.mode == capability_id("Tc"))) {
+                m_capabilities.palette = Palette::TRUE_COLOR;
+            }
+            break;
+        case TerminalReport::type_t::DeviceAttributes:
+            if (!m_complete) {
+                m_complete = true;
+                if (m_use_cache) save_cache();
+            }
+            break;
+    }
+    return m_capabilities != before;
+}
+
+std::string CapabilityProbe::cache_path() {
+    const std::string_view cache_home = get_env("XDG_CACHE_HOME");
+    if (!cache_home.empty()) return std::string(cache_home) + "/tuiengine/capabilities";
+    const std::string_view home = get_env("HOME");
+    if (!home.empty()) return std::string(home) + "/.cache/tuiengine/capabilities";
+    return "";
+}
+
+// One line per terminal: the key, a tab and the capabilities as numbers
+bool CapabilityProbe::load_cache() {
+    const std::string path = cache_path();
+    if (path.empty()) return false;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t tab = line.rfind('\t');
+        if (tab == std::string::npos || line.compare(0, tab, m_cache_key) != 0 || tab != m_cache_key.size()) continue;
+        std::istringstream values(line.substr(tab + 1));
+        int palette;
+        Capabilities capabilities;
+        if (!(values >> palette >> capabilities.synchronized_output >> capabilities.sgr_mouse >>
+              capabilities.bracketed_paste >> capabilities.kitty_keyboard)) {
+            return false;
+        }
+        capabilities.palette = static_cast<Palette>(palette);
+        m_capabilities = capabilities;
+        return true;
+    }
+    return false;
+}
+
+void CapabilityProbe::save_cache() const {
+    const std::string path = cache_path();
+    if (path.empty()) return;
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.starts_with(m_cache_key + '\t')) lines.push_back(line);
+        }
+    }
+    std::ostringstream line;
+    line << m_cache_key << '\t' << static_cast<int>(m_capabilities.palette) << ' ' << m_capabilities.synchronized_output
+         << ' ' << m_capabilities.sgr_mouse << ' ' << m_capabilities.bracketed_paste << ' '
+         << m_capabilities.kitty_keyboard;
+    lines.push_back(line.str());
+
+    // Written aside and renamed, so another process never reads half a file. A cache that cannot be written only
+    // means probing again next time.
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    const std::string temporary_path = path + "." + std::to_string(getpid());
+    {
+        std::ofstream file(temporary_path, std::ios::out | std::ios::trunc);
+        for (const std::string& cached : lines) {
+            file << cached << '\n';
+        }
+        if (!file) return;
+    }
+    std::filesystem::rename(temporary_path, path, error);
+}
+
+}  // namespace TUIE
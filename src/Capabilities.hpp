@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+
+#include "Input.hpp"
+#include "Palette.hpp"
+#include "Terminal.hpp"
+
+namespace TUIE {
+
+// What the terminal supports. Until the probe answers they are guessed from the environment (COLORTERM, TERM) and
+// the modes every common terminal has are assumed.
+struct Capabilities {
+    Palette palette = Palette::TRUE_COLOR;
+    bool synchronized_output = false;
+    bool sgr_mouse = true;
+    bool bracketed_paste = true;
+    bool kitty_keyboard = false;
+
+    bool operator==(const Capabilities& other) const = default;
+};
+
+// Probes the capabilities of a terminal with DECRQM, the kitty keyboard query and XTGETTCAP, closed by a DA1 query
+// that every terminal answers, so once it arrives the probe is complete. The replies arrive as input and nothing
+// waits for them, they are applied on the frame they arrive.
+//
+// The result of the terminal of the process is cached on disk ($XDG_CACHE_HOME/tuiengine/capabilities), keyed by
+// TERM, TERM_PROGRAM and TERM_PROGRAM_VERSION, so later launches read one file and send no queries. Delete the file
+// to probe again.
+class CapabilityProbe {
+   public:
+    // Without cache the environment does not describe the terminal (a pty served by the process), nothing is guessed
+    explicit CapabilityProbe(bool use_cache);
+
+   public:
+    // Sends the queries, unless the capabilities came from the cache
+    void start(Terminal& terminal);
+    // True when the report changed the capabilities
+    bool on_report(const TerminalReport& report);
+    bool is_complete() const { return m_complete; }
+    const Capabilities& get() const { return m_capabilities; }
+
+   private:
+    bool load_cache();
+    void save_cache() const;
+    static std::string cache_path();
+
+   private:
+    Capabilities m_capabilities;
+    bool m_use_cache;
+    bool m_complete = false;
+    std::string m_cache_key;
+};
+
+}  // namespace TUIE
@@ -0,0 +1,56 @@
+#include "FileWatcher.hpp"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace TUIE {
+
+FileWatcher::FileWatcher(const std::string& path) : m_path(path) {
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        throw std::runtime_error(std::string("Could not initialize inotify: ") + std::strerror(errno));
+    }
+    const size_t slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    m_name = slash == std::string::npos ? path : path.substr(slash + 1);
+    m_dir_watch = inotify_add_watch(m_fd, dir.c_str(), IN_CREATE | IN_MOVED_TO);
+    watch_file();
+}
+
+FileWatcher::~FileWatcher() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+void FileWatcher::watch_file() {
+    m_file_watch =
+        inotify_add_watch(m_fd, m_path.c_str(), IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF | IN_CLOSE_WRITE);
+}
+
+bool FileWatcher::read_events() {
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+    while (true) {
+        const ssize_t size = read(m_fd, buffer, sizeof(buffer));
+        if (size <= 0) break;
+        for (char* it = buffer; it < buffer + size;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(it);
+            if (event->wd == m_file_watch) {
+                changed = true;
+            } else if (event->wd == m_dir_watch && event->len > 0 && m_name == event->name) {
+                // The file was created again after a rotation, the watch follows the new one
+                inotify_rm_watch(m_fd, m_file_watch);
+                watch_file();
+                changed = true;
+            }
+            it += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
+}  // namespace TUIE
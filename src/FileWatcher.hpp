@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+namespace TUIE {
+
+// inotify watch of a file and of its directory, so writes, truncations and rotations (the file renamed or deleted
+// and created again) are all noticed. The fd can be waited on with the engine (engine::watch_fd).
+class FileWatcher {
+   public:
+    explicit FileWatcher(const std::string& path);
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+   public:
+    int get_fd() const { return m_fd; }
+    // Drains the pending events, returns true if any of them is about the file
+    bool read_events();
+
+   private:
+    void watch_file();
+
+   private:
+    std::string m_path;
+    std::string m_name;
+    int m_fd = -1;
+    int m_file_watch = -1;
+    int m_dir_watch = -1;
+};
+
+}  // namespace TUIE
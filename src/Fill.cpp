@@ -0,0 +1,128 @@
+#include "Fill.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <span>
+#include <vector>
+
+namespace TUIE {
+
+namespace {
+
+constexpr int32_t ONE = 1 << 16;
+
+Rect clip(const TerminalBuffer& buffer, Rect rect) {
+    const int left = std::max(rect.x, 0);
+    const int top = std::max(rect.y, 0);
+    const int right = std::min(rect.x + rect.width, buffer.get_width());
+    const int bottom = std::min(rect.y + rect.height, buffer.get_height());
+    return {left, top, right - left, bottom - top};
+}
+
+std::span<TerminalCell> row_of(TerminalBuffer& buffer, Rect clipped, int y) {
+    return buffer.cells().subspan(y * buffer.get_width() + clipped.x, clipped.width);
+}
+
+// Color at t, with t in fixed point from 0 to ONE
+Color lerp(Color from, Color to, int32_t t) {
+    t = std::clamp(t, 0, ONE);
+    return {static_cast<uint8_t>(from.r + ((to.r - from.r) * t >> 16)),
+            static_cast<uint8_t>(from.g + ((to.g - from.g) * t >> 16)),
+            static_cast<uint8_t>(from.b + ((to.b - from.b) * t >> 16))};
+}
+
+}  // namespace
+
+void fill_linear_gradient(TerminalBuffer& buffer, Rect rect, Color from, Color to, float angle) {
+    const Rect clipped = clip(buffer, rect);
+    if (clipped.empty()) return;
+
+    // Project the cell centers on the direction and map the extent of the whole rect to [0, ONE], so a clipped rect
+    // keeps the same colors. Then t is linear in x and y and every row is a fixed point ramp.
+    const float radians = angle * std::numbers::pi_v<float> / 180;
+    const float dx = std::cos(radians);
+    const float dy = std::sin(radians) * 2;
+    const float extent = std::abs(dx) * (rect.width - 1) + std::abs(dy) * (rect.height - 1);
+    const float scale = extent > 0 ? ONE / extent : 0;
+    const float origin = std::min(dx, 0.0f) * (rect.width - 1) + std::min(dy, 0.0f) * (rect.height - 1);
+    const int32_t step_x = std::lround(dx * scale);
+    const int32_t step_y = std::lround(dy * scale);
+    const int32_t start = std::lround(-origin * scale);
+
+    for (int y = clipped.y; y < clipped.y + clipped.height; y++) {
+        std::span<TerminalCell> row = row_of(buffer, clipped, y);
+        int32_t t = start + (y - rect.y) * step_y + (clipped.x - rect.x) * step_x;
+        for (TerminalCell& cell : row) {
+            cell = {U' ', BLACK, lerp(from, to, t)};
+            t += step_x;
+        }
+    }
+}
+
+void fill_radial_gradient(TerminalBuffer& buffer, Rect rect, Color inner, Color outer) {
+    const Rect clipped = clip(buffer, rect);
+    if (clipped.empty()) return;
+
+    // Normalized squared distances of the columns are shared by all the rows
+    const float center_x = rect.width / 2.0f;
+    const float center_y = rect.height / 2.0f;
+    std::vector<float> column_distance(clipped.width);
+    for (int i = 0; i < clipped.width; i++) {
+        const float dx = (clipped.x - rect.x + i + 0.5f - center_x) / center_x;
+        column_distance[i] = dx * dx;
+    }
+    for (int y = clipped.y; y < clipped.y + clipped.height; y++) {
+        std::span<TerminalCell> row = row_of(buffer, clipped, y);
+        const float dy = (y - rect.y + 0.5f - center_y) / center_y;
+        for (int i = 0; i < clipped.width; i++) {
+            const int32_t t = std::lround(std::sqrt(column_distance[i] + dy * dy) * ONE);
+            row[i] = {U' ', BLACK, lerp(inner, outer, t)};
+        }
+    }
+}
+
+void fill_checkerboard(TerminalBuffer& buffer, Rect rect, Color first, Color second, int cell_width, int cell_height) {
+    const Rect clipped = clip(buffer, rect);
+    if (clipped.empty() || cell_width <= 0 || cell_height <= 0) return;
+    for (int y = clipped.y; y < clipped.y + clipped.height; y++) {
+        std::span<TerminalCell> row = row_of(buffer, clipped, y);
+        const bool odd_row = (y - rect.y) / cell_height % 2;
+        for (int i = 0; i < clipped.width; i++) {
+            const bool odd_column = (clipped.x - rect.x + i) / cell_width % 2;
+            row[i] = {U' ', BLACK, odd_row != odd_column ? second : first};
+        }
+    }
+}
+
+void fill_stripes(TerminalBuffer& buffer, Rect rect, Color first, Color second, int width, bool vertical) {
+    const Rect clipped = clip(buffer, rect);
+    if (clipped.empty() || width <= 0) return;
+    for (int y = clipped.y; y < clipped.y + clipped.height; y++) {
+        std::span<TerminalCell> row = row_of(buffer, clipped, y);
+        if (vertical) {
+            for (int i = 0; i < clipped.width; i++) {
+                row[i] = {U' ', BLACK, (clipped.x - rect.x + i) / width % 2 ? second : first};
+            }
+        } else {
+            std::ranges::fill(row, TerminalCell{U' ', BLACK, (y - rect.y) / width % 2 ? second : first});
+        }
+    }
+}
+
+void shade(TerminalBuffer& buffer, Rect rect, Color color, uint8_t alpha) {
+    const Rect clipped = clip(buffer, rect);
+    if (clipped.empty()) return;
+    // alpha 255 has to give the color itself, so it is scaled to 256
+    const int32_t weight = alpha + (alpha >> 7);
+    for (int y = clipped.y; y < clipped.y + clipped.height; y++) {
+        for (TerminalCell& cell : row_of(buffer, clipped, y)) {
+            const Color background = cell.background_color.without_color ? BLACK : cell.background_color;
+            cell.background_color = {static_cast<uint8_t>(background.r + ((color.r - background.r) * weight >> 8)),
+                                     static_cast<uint8_t>(background.g + ((color.g - background.g) * weight >> 8)),
+                                     static_cast<uint8_t>(background.b + ((color.b - background.b) * weight >> 8))};
+        }
+    }
+}
+
+}  // namespace TUIE
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Color.hpp"
+#include "Rect.hpp"
+#include "TerminalBuffer.hpp"
+
+namespace TUIE {
+
+// Fill kernels behind the engine gradient and pattern draws. They clip the rect once and then work on whole rows of
+// cells, the colors are interpolated in 16.16 fixed point. The filled cells are spaces over the computed background.
+
+// The angle is in degrees, 0 goes from left to right and 90 from top to bottom. Cells count as twice as tall as wide.
+void fill_linear_gradient(TerminalBuffer& buffer, Rect rect, Color from, Color to, float angle);
+// From inner at the center to outer at the edges of the ellipse inscribed in the rect
+void fill_radial_gradient(TerminalBuffer& buffer, Rect rect, Color inner, Color outer);
+void fill_checkerboard(TerminalBuffer& buffer, Rect rect, Color first, Color second, int cell_width, int cell_height);
+void fill_stripes(TerminalBuffer& buffer, Rect rect, Color first, Color second, int width, bool vertical);
+// Blends color over the backgrounds already in the rect, alpha 0 keeps them and 255 replaces them. Characters and
+// foregrounds are kept, the terminal background counts as black.
+void shade(TerminalBuffer& buffer, Rect rect, Color color, uint8_t alpha);
+
+}  // namespace TUIE
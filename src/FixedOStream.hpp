@@ -1,18 +1,27 @@
 #pragma once
 
+#include <unistd.h>
+
+#include <cerrno>
 #include <iostream>
+#include <string>
 
 namespace TUIE {
 
 struct FixedBuffer : std::streambuf {
-    FILE *m_file;
+    FILE *m_file = nullptr;
+    int m_fd = -1;
+    // Bytes a non-blocking fd did not take yet, they are sent before anything written after them
+    std::string m_backlog;
+    size_t m_bytes_sent = 0;
 
     FixedBuffer(char *buf, size_t size, FILE *file) : m_file(file) { setp(buf, buf + size); }
+    FixedBuffer(char *buf, size_t size, int fd) : m_fd(fd) { setp(buf, buf + size); }
 
     ~FixedBuffer() override { sync(); }
 
     int_type overflow(int_type c) override {
-        if (m_file) {
+        if (m_file || m_fd >= 0) {
             flush_to_file();
             if (!traits_type::eq_int_type(c, traits_type::eof())) {
                 sputc(traits_type::to_char_type(c));
@@ -23,21 +32,63 @@ struct FixedBuffer : std::streambuf {
     }
 
     int sync() override {
-        if (m_file) {
-            flush_to_file();
-        }
+        flush_to_file();
         return 0;
     }
 
     void flush_to_file() {
-        if (!m_file) return;
+        if (!m_file && m_fd < 0) return;
         std::ptrdiff_t n = pptr() - pbase();
         if (n > 0) {
-            fwrite(pbase(), 1, n, m_file);
-            fflush(m_file);
+            if (m_file) {
+                fwrite(pbase(), 1, n, m_file);
+                fflush(m_file);
+            } else {
+                write_to_fd(pbase(), n);
+            }
             setp(pbase(), epptr());  // Reset pointers
         }
     }
+
+    void write_to_fd(const char *data, std::ptrdiff_t size) {
+        if (!m_backlog.empty()) {
+            m_backlog.append(data, size);
+            flush_backlog();
+            return;
+        }
+        const std::ptrdiff_t written = write_some(data, size);
+        if (written >= 0 && written < size) {
+            m_backlog.assign(data + written, size - written);
+        }
+    }
+
+    // Writes as much of the backlog as the fd takes without blocking, true when it is empty
+    bool flush_backlog() {
+        if (m_backlog.empty()) return true;
+        const std::ptrdiff_t written = write_some(m_backlog.data(), m_backlog.size());
+        if (written < 0) {
+            m_backlog.clear();
+        } else {
+            m_backlog.erase(0, written);
+        }
+        return m_backlog.empty();
+    }
+
+    // Bytes written until the fd would block, or -1 when the other end is gone (there is nobody left to draw to)
+    std::ptrdiff_t write_some(const char *data, std::ptrdiff_t size) {
+        std::ptrdiff_t total = 0;
+        while (total < size) {
+            const ssize_t written = ::write(m_fd, data + total, size - total);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return -1;
+            }
+            total += written;
+            m_bytes_sent += written;
+        }
+        return total;
+    }
 };
 
 template <size_t Capacity>
@@ -46,18 +97,26 @@ struct FixedOStreamStorage {
     FixedBuffer m_storage;
 
     FixedOStreamStorage(FILE *file) : m_storage(m_buffer, Capacity, file) {}
+    FixedOStreamStorage(int fd) : m_storage(m_buffer, Capacity, fd) {}
 };
 
 template <size_t Capacity>
 struct FixedOStream : private FixedOStreamStorage<Capacity>, public std::ostream {
     FixedOStream() : FixedOStreamStorage<Capacity>(nullptr), std::ostream(&this->m_storage) {}
     FixedOStream(FILE *file) : FixedOStreamStorage<Capacity>(file), std::ostream(&this->m_storage) {}
+    FixedOStream(int fd) : FixedOStreamStorage<Capacity>(fd), std::ostream(&this->m_storage) {}
 
     void clear_buffer() {
         this->m_storage.clear();
         this->clear();
     }
 
+    // Output of a non-blocking fd that is still waiting for the terminal to take it
+    size_t backlog_size() const { return this->m_storage.m_backlog.size(); }
+    bool flush_backlog() { return this->m_storage.flush_backlog(); }
+    size_t bytes_sent() const { return this->m_storage.m_bytes_sent; }
+    int get_fd() const { return this->m_storage.m_fd; }
+
     std::string_view sv() const { return std::string_view(this->m_storage.pbase(), this->m_storage.size()); }
 };
 
@@ -0,0 +1,226 @@
+#include "Image.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "TUIengine.hpp"
+
+namespace TUIE {
+
+namespace {
+
+// 4x4 Bayer matrix, thresholds from 0 to 15
+constexpr int BAYER[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+// Limits for the size read from a PPM header, which can not be trusted. Far beyond any terminal, and small enough that
+// the pixel indices fit in an int.
+constexpr int MAX_PPM_SIDE = 1 << 15;
+constexpr size_t MAX_PPM_PIXELS = size_t(1) << 26;
+
+int read_ppm_number(std::istream& in) {
+    // Skips the whitespace and the comments between the header fields
+    while (true) {
+        in >> std::ws;
+        if (in.peek() != '#') break;
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    int value;
+    if (!(in >> value)) {
+        throw std::runtime_error("Malformed PPM header");
+    }
+    return value;
+}
+
+}  // namespace
+
+Image::Image(int width, int height) : m_width(width), m_height(height) {
+    if (width < 0 || height < 0) {
+        throw std::invalid_argument("Image size can not be negative");
+    }
+    m_pixels.assign(static_cast<size_t>(width) * static_cast<size_t>(height), BLACK);
+}
+
+Image Image::load_ppm(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open image: " + path);
+    }
+    char magic[2];
+    if (!file.read(magic, 2) || magic[0] != 'P' || (magic[1] != '6' && magic[1] != '3')) {
+        throw std::runtime_error("Not a PPM image: " + path);
+    }
+    const int width = read_ppm_number(file);
+    const int height = read_ppm_number(file);
+    const int max_value = read_ppm_number(file);
+    if (width <= 0 || height <= 0 || max_value <= 0 || max_value > 255) {
+        throw std::runtime_error("Unsupported PPM image: " + path);
+    }
+    const size_t pixel_count = static_cast<size_t>(width) * static_cast<size_t>(height);
+    if (width > MAX_PPM_SIDE || height > MAX_PPM_SIDE || pixel_count > MAX_PPM_PIXELS) {
+        throw std::runtime_error("PPM image too large: " + path);
+    }
+
+    Image image(width, height);
+    if (magic[1] == '6') {
+        // A single whitespace separates the header from the samples
+        file.get();
+        std::vector<uint8_t> samples(pixel_count * 3);
+        if (!file.read(reinterpret_cast<char*>(samples.data()), samples.size())) {
+            throw std::runtime_error("Truncated PPM image: " + path);
+        }
+        for (size_t i = 0; i < image.m_pixels.size(); i++) {
+            image.m_pixels[i] = {static_cast<uint8_t>(samples[i * 3] * 255 / max_value),
+                                 static_cast<uint8_t>(samples[i * 3 + 1] * 255 / max_value),
+                                 static_cast<uint8_t>(samples[i * 3 + 2] * 255 / max_value)};
+        }
+    } else {
+        for (Color& pixel : image.m_pixels) {
+            const int r = read_ppm_number(file);
+            const int g = read_ppm_number(file);
+            const int b = read_ppm_number(file);
+            pixel = {static_cast<uint8_t>(r * 255 / max_value), static_cast<uint8_t>(g * 255 / max_value),
+                     static_cast<uint8_t>(b * 255 / max_value)};
+        }
+    }
+    return image;
+}
+
+Color Image::get_pixel(int x, int y) const {
+    if (x < 0 || x >= m_width || y < 0 || y >= m_height) {
+        throw std::out_of_range("x or y is out of bounds");
+    }
+    return m_pixels[y * m_width + x];
+}
+
+void Image::set_pixel(int x, int y, Color color) {
+    if (x < 0 || x >= m_width || y < 0 || y >= m_height) {
+        throw std::out_of_range("x or y is out of bounds");
+    }
+    m_pixels[y * m_width + x] = color;
+    m_cache.clear();
+}
+
+Image Image::scaled(int width, int height) const {
+    Image result(width, height);
+    if (width == 0 || height == 0 || m_width == 0 || m_height == 0) return result;
+
+    // Source span of every output column and row, at least one pixel wide when enlarging
+    const auto spans = [](int source_size, int size) {
+        std::vector<std::pair<int, int>> spans(size);
+        for (int i = 0; i < size; i++) {
+            const int begin = static_cast<int64_t>(i) * source_size / size;
+            const int end = static_cast<int64_t>(i + 1) * source_size / size;
+            spans[i] = {begin, std::max(end, begin + 1)};
+        }
+        return spans;
+    };
+    const auto columns = spans(m_width, width);
+    const auto rows = spans(m_height, height);
+
+    // Separable filter: sum the columns of every source row, then the rows of every output column
+    std::vector<uint32_t> horizontal(width * m_height * 3);
+    for (int y = 0; y < m_height; y++) {
+        const Color* source = m_pixels.data() + y * m_width;
+        uint32_t* sums = horizontal.data() + y * width * 3;
+        for (int x = 0; x < width; x++) {
+            uint32_t r = 0, g = 0, b = 0;
+            for (int i = columns[x].first; i < columns[x].second; i++) {
+                r += source[i].r;
+                g += source[i].g;
+                b += source[i].b;
+            }
+            sums[x * 3] = r;
+            sums[x * 3 + 1] = g;
+            sums[x * 3 + 2] = b;
+        }
+    }
+    std::vector<uint32_t> vertical(width * 3);
+    for (int y = 0; y < height; y++) {
+        std::fill(vertical.begin(), vertical.end(), 0);
+        for (int i = rows[y].first; i < rows[y].second; i++) {
+            const uint32_t* sums = horizontal.data() + i * width * 3;
+            for (int x = 0; x < width * 3; x++) {
+                vertical[x] += sums[x];
+            }
+        }
+        const int row_count = rows[y].second - rows[y].first;
+        for (int x = 0; x < width; x++) {
+            const uint32_t count = row_count * (columns[x].second - columns[x].first);
+            result.m_pixels[y * width + x] = {static_cast<uint8_t>(vertical[x * 3] / count),
+                                              static_cast<uint8_t>(vertical[x * 3 + 1] / count),
+                                              static_cast<uint8_t>(vertical[x * 3 + 2] / count)};
+        }
+    }
+    return result;
+}
+
+void Image::quantize(Palette palette, Dither dither) {
+    m_cache.clear();
+    if (palette == Palette::TRUE_COLOR) return;
+
+    if (dither == Dither::FLOYD_STEINBERG) {
+        // Errors carried to the current and the next row, with one pixel of margin at each side
+        std::vector<int> current((m_width + 2) * 3, 0);
+        std::vector<int> next((m_width + 2) * 3, 0);
+        for (int y = 0; y < m_height; y++) {
+            std::fill(next.begin(), next.end(), 0);
+            for (int x = 0; x < m_width; x++) {
+                Color& pixel = m_pixels[y * m_width + x];
+                int* error = current.data() + (x + 1) * 3;
+                const int r = pixel.r + error[0] / 16;
+                const int g = pixel.g + error[1] / 16;
+                const int b = pixel.b + error[2] / 16;
+                const Color color = nearest_color(r, g, b, palette);
+                const int diff[3] = {r - color.r, g - color.g, b - color.b};
+                for (int c = 0; c < 3; c++) {
+                    error[3 + c] += diff[c] * 7;
+                    next[x * 3 + c] += diff[c] * 3;
+                    next[(x + 1) * 3 + c] += diff[c] * 5;
+                    next[(x + 2) * 3 + c] += diff[c];
+                }
+                pixel = color;
+            }
+            std::swap(current, next);
+        }
+        return;
+    }
+
+    // The ordered threshold spreads over about one step of the palette
+    const int spread = palette == Palette::COLORS_16 ? 128 : 40;
+    for (int y = 0; y < m_height; y++) {
+        for (int x = 0; x < m_width; x++) {
+            Color& pixel = m_pixels[y * m_width + x];
+            const int offset = dither == Dither::ORDERED ? (BAYER[y % 4][x % 4] * 2 - 15) * spread / 32 : 0;
+            pixel = nearest_color(pixel.r + offset, pixel.g + offset, pixel.b + offset, palette);
+        }
+    }
+}
+
+void Image::draw(engine& engine, Rect rect, ImageOptions options) {
+    if (rect.empty()) return;
+    auto entry = std::ranges::find_if(m_cache, [&](const CacheEntry& entry) {
+        return entry.columns == rect.width && entry.rows == rect.height && entry.options == options;
+    });
+    if (entry == m_cache.end()) {
+        Image image = scaled(rect.width, rect.height * 2);
+        image.quantize(options.palette, options.dither);
+        Canvas canvas(rect.width, rect.height, CanvasMode::HALF_BLOCK);
+        for (int y = 0; y < image.m_height; y++) {
+            for (int x = 0; x < image.m_width; x++) {
+                canvas.set_pixel(x, y, image.m_pixels[y * image.m_width + x]);
+            }
+        }
+        if (m_cache.size() == CACHE_SIZE) {
+            m_cache.pop_back();
+        }
+        m_cache.insert(m_cache.begin(), {rect.width, rect.height, options, std::move(canvas)});
+    } else if (entry != m_cache.begin()) {
+        std::rotate(m_cache.begin(), entry, entry + 1);
+    }
+    m_cache.front().canvas.draw(engine, rect.x, rect.y);
+}
+
+}  // namespace TUIE
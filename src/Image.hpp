@@ -0,0 +1,61 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Canvas.hpp"
+#include "Color.hpp"
+#include "Palette.hpp"
+#include "Rect.hpp"
+
+namespace TUIE {
+
+class engine;
+
+enum class Dither { NONE, ORDERED, FLOYD_STEINBERG };
+
+struct ImageOptions {
+    Palette palette = Palette::TRUE_COLOR;
+    Dither dither = Dither::NONE;
+
+    bool operator==(const ImageOptions& other) const = default;
+};
+
+// RGB image that is drawn with half blocks, two pixels per cell. The scaled and quantized result is cached per size
+// and options, so it is only computed again after a resize or a change of options, not on every frame.
+class Image {
+   public:
+    Image(int width, int height);
+    // Binary (P6) or plain (P3) PPM with a maximum value up to 255
+    static Image load_ppm(const std::string& path);
+
+   public:
+    int get_width() const { return m_width; }
+    int get_height() const { return m_height; }
+    std::span<const Color> pixels() const { return m_pixels; }
+    Color get_pixel(int x, int y) const;
+    void set_pixel(int x, int y, Color color);
+
+    // Box filter, every pixel is the average of the source pixels it covers
+    Image scaled(int width, int height) const;
+    void quantize(Palette palette, Dither dither);
+    void draw(engine& engine, Rect rect, ImageOptions options = {});
+
+   private:
+    int m_width;
+    int m_height;
+    std::vector<Color> m_pixels;
+
+    struct CacheEntry {
+        int columns;
+        int rows;
+        ImageOptions options;
+        Canvas canvas;
+    };
+    // Most recently used first, a few entries are enough for a resize back and forth
+    static constexpr size_t CACHE_SIZE = 4;
+    std::vector<CacheEntry> m_cache;
+};
+
+}  // namespace TUIE
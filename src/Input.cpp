@@ -3,10 +3,63 @@
 #include <poll.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <charconv>
+#include <csignal>
+#include <utility>
+#include <cstring>
+
+#include "Recorder.hpp"
+#include "Scheduler.hpp"
+#include "Trace.hpp"
 #include "debug.hpp"
 
 namespace TUIE {
 
+namespace {
+
+// Keys of the CSI sequences ending in a letter (ESC [ 1 ; modifiers X) or in ~ (ESC [ number ; modifiers ~)
+constexpr std::pair<char, KEYS> LETTER_KEYS[] = {
+    {'A', KEYS::UP}, {'B', KEYS::DOWN}, {'C', KEYS::RIGHT}, {'D', KEYS::LEFT}, {'H', KEYS::HOME},
+    {'F', KEYS::END}, {'P', KEYS::F1},  {'Q', KEYS::F2},    {'R', KEYS::F3},   {'S', KEYS::F4},
+};
+constexpr std::pair<int, KEYS> TILDE_KEYS[] = {
+    {1, KEYS::HOME}, {2, KEYS::INSERT}, {3, KEYS::DELETE}, {4, KEYS::END},  {5, KEYS::PAGE_UP}, {6, KEYS::PAGE_DOWN},
+    {7, KEYS::HOME}, {8, KEYS::END},    {11, KEYS::F1},    {12, KEYS::F2},  {13, KEYS::F3},     {14, KEYS::F4},
+    {15, KEYS::F5},  {17, KEYS::F6},    {18, KEYS::F7},    {19, KEYS::F8},  {20, KEYS::F9},     {21, KEYS::F10},
+    {23, KEYS::F11}, {24, KEYS::F12},
+};
+// Kitty key codes of the keys that do not type a character
+constexpr std::pair<int, KEYS> KITTY_KEYS[] = {
+    {27, KEYS::ESCAPE}, {13, KEYS::ENTER}, {9, KEYS::TAB}, {127, KEYS::BACKSPACE}, {' ', KEYS::SPACE},
+};
+
+}  // namespace
+
+KeyAwaiter Input::key() const { return {}; }
+
+int Input::get_key_presses(char c) const {
+    int presses = 0;
+    for (const auto &event : m_events) {
+        if (event.type == InputEvent::type_t::Keyboard && event.as.keyboardEvent.key == KEYS::CHARACTER &&
+            event.as.keyboardEvent.character == c && event.as.keyboardEvent.action != KEY_ACTION::RELEASED) {
+            presses++;
+        }
+    }
+    return presses;
+}
+
+int Input::get_key_presses(KEYS key) const {
+    int presses = 0;
+    for (const auto &event : m_events) {
+        if (event.type == InputEvent::type_t::Keyboard && event.as.keyboardEvent.key == key &&
+            event.as.keyboardEvent.action != KEY_ACTION::RELEASED) {
+            presses++;
+        }
+    }
+    return presses;
+}
+
 std::ostream &operator<<(std::ostream &os, const KEYS &key) {
 #define CASE_KEY(key) \
     case KEYS::key:   \
@@ -41,6 +94,7 @@ std::ostream &operator<<(std::ostream &os, const KEYS &key) {
         CASE_KEY(F10);
         CASE_KEY(F11);
         CASE_KEY(F12);
+        CASE_KEY(SIZE);
         case KEYS::CHARACTER:
             return os;
     }
@@ -77,9 +131,23 @@ std::ostream &operator<<(std::ostream &os, const MOUSE_ACTION &action) {
     return os;
 }
 
+std::ostream &operator<<(std::ostream &os, const KEY_ACTION &action) {
+#define CASE_KEY_ACTION(key) \
+    case KEY_ACTION::key:    \
+        return os << #key;
+    switch (action) {
+        CASE_KEY_ACTION(PRESSED);
+        CASE_KEY_ACTION(REPEATED);
+        CASE_KEY_ACTION(RELEASED);
+    }
+    return os;
+}
+
 std::ostream &operator<<(std::ostream &os, const KeyboardEvent &event) {
     os << "Keyboard: " << event.key;
     if (event.key == KEYS::CHARACTER) os << " ('" << event.character << "')";
+    os << " " << event.action;
+    if (event.modifiers) os << " modifiers " << static_cast<int>(event.modifiers);
     return os;
 }
 
@@ -108,27 +176,109 @@ std::ostream &operator<<(std::ostream &os, const InputEvent &event) {
     return os;
 }
 
+void Input::set_kitty_keyboard(bool enable) {
+    if (enable != m_kitty_keyboard) {
+        // The keys down were tracked by the other protocol, their releases would never arrive
+        m_keys.down.reset();
+        m_characters.down.reset();
+    }
+    m_kitty_keyboard = enable;
+}
+
+void Input::clear_events() {
+    m_events.clear();
+    m_reports.clear();
+    m_arena.reset();
+
+    if (m_kitty_keyboard) {
+        // The release events say when a key goes up
+        m_keys.released.reset();
+        m_keys.pressed.reset();
+        m_characters.released.reset();
+        m_characters.pressed.reset();
+    } else {
+        // Without release events the keys are held only while they keep arriving, so everything starts the frame up
+        // and process_input() derives the releases from what was down on the previous frame
+        m_keys.released = m_keys.down;
+        m_keys.pressed.reset();
+        m_keys.down.reset();
+        m_characters.released = m_characters.down;
+        m_characters.pressed.reset();
+        m_characters.down.reset();
+    }
+
+    m_mouse.pressed.reset();
+    m_mouse.released.reset();
+    m_scroll_up = 0;
+    m_scroll_down = 0;
+}
+
+void Input::add_event(const InputEvent &event) {
+    m_events.push_back(event);
+    switch (event.type) {
+        case InputEvent::type_t::Keyboard: {
+            const KeyboardEvent &keyboard_event = event.as.keyboardEvent;
+            const bool release = keyboard_event.action == KEY_ACTION::RELEASED;
+            const bool repeat = keyboard_event.action == KEY_ACTION::REPEATED;
+            // Without release events `released` still holds what was down on the previous frame, so a key found there
+            // is being auto-repeated
+            if (keyboard_event.key == KEYS::CHARACTER) {
+                const unsigned char character = static_cast<unsigned char>(keyboard_event.character);
+                const bool held = !m_kitty_keyboard && m_characters.released.test(character);
+                release ? m_characters.release(character) : m_characters.press(character, repeat || held);
+            } else {
+                const int key = static_cast<int>(keyboard_event.key);
+                const bool held = !m_kitty_keyboard && m_keys.released.test(key);
+                release ? m_keys.release(key) : m_keys.press(key, repeat || held);
+            }
+            break;
+        }
+        case InputEvent::type_t::Mouse: {
+            const MouseEvent &mouse_event = event.as.mouseEvent;
+            const int button = static_cast<int>(mouse_event.button);
+            m_mouse_position = mouse_event.position;
+            if (mouse_event.button == MOUSE_BUTTONS::WHEEL_UP) {
+                m_scroll_up++;
+                m_mouse.pressed.set(button);
+            } else if (mouse_event.button == MOUSE_BUTTONS::WHEEL_DOWN) {
+                m_scroll_down++;
+                m_mouse.pressed.set(button);
+            } else if (mouse_event.button == MOUSE_BUTTONS::POSITION || mouse_event.button == MOUSE_BUTTONS::DRAG) {
+                // Motion reports, they happen on this frame but are never held
+                m_mouse.pressed.set(button);
+            } else if (mouse_event.action == MOUSE_ACTION::PRESSED) {
+                m_mouse.press(button);
+            } else {
+                m_mouse.release(button);
+            }
+            break;
+        }
+        case InputEvent::type_t::Paste:
+            break;
+    }
+}
+
 bool Input::have_to_read() {
-    struct pollfd pollfd = {STDIN_FILENO, POLLIN, 0};
+    struct pollfd pollfd = {m_fd, POLLIN, 0};
     bool ret = poll(&pollfd, 1, 0) == 1;
-    debug_msg("Have to read: " << ret);
+    log_msg(LogCategory::INPUT, LogLevel::VERBOSE, "Have to read: " << ret);
     return ret;
 }
 
-int Input::get_byte() {
-    int r;
-    unsigned char c;
-    if ((r = read(STDIN_FILENO, &c, sizeof(c))) < 0) return r;
-    debug_msg("Read byte: " << (char)c);
-    return c;
+bool Input::fill_read_buffer() {
+    if (!have_to_read()) return false;
+    ssize_t r = read(m_fd, m_read_buffer, sizeof(m_read_buffer));
+    if (r <= 0) return false;
+    m_read_begin = 0;
+    m_read_end = r;
+    if (m_recorder) m_recorder->record_input(std::string_view(m_read_buffer, r));
+    log_msg(LogCategory::INPUT, LogLevel::INFO, "Read bytes: " << r);
+    return true;
 }
 
 void Input::handle_key(char byte) {
-    if (byte >= 'a' && byte <= 'z') {
-        add_event((char)byte);
-    } else if (byte >= 'A' && byte <= 'Z') {
-        add_event((char)byte);
-    } else if (byte >= '0' && byte <= '9') {
+    if (byte >= '!' && byte <= '~') {
+        // Every printable character except space, which is its own key
         add_event((char)byte);
     } else if (byte == ' ') {
         add_event(KEYS::SPACE);
@@ -146,14 +296,24 @@ void Input::handle_key(char byte) {
 }
 
 void Input::process_input() {
-    while (have_to_read()) {
-        int byte_int = get_byte();
-        if (byte_int == -1) break;
-        char byte = (char)byte_int;
+    TRACE_SCOPE("Input::process_input");
+    size_t paste_bytes = 0;
+    while (true) {
+        if (m_read_begin == m_read_end && !fill_read_buffer()) break;
+
+        if (m_state == State::PASTE_CONTENT) {
+            // Once the frame budget is used the rest of the paste is left unread for the next frames
+            if (paste_bytes >= m_paste_limit) break;
+            paste_bytes += process_paste(m_paste_limit - paste_bytes);
+            continue;
+        }
 
+        char byte = m_read_buffer[m_read_begin++];
         switch (m_state) {
             case State::NORMAL:
-                if (byte == '\x1B' && have_to_read()) {
+                // With the kitty protocol the ESC key is a sequence too, so a lone ESC byte is always the start of one,
+                // even when the rest of it is not read yet
+                if (byte == '\x1B' && (m_kitty_keyboard || m_read_begin < m_read_end || have_to_read())) {
                     m_state = State::ESC;
                 } else {
                     handle_key(byte);
@@ -163,6 +323,11 @@ void Input::process_input() {
                 if (byte == '[') {
                     m_state = State::CSI;
                     m_buffer.clear();
+                } else if (byte == 'P' && (m_read_begin < m_read_end || have_to_read())) {
+                    m_state = State::DCS;
+                    m_buffer.clear();
+                } else if (byte == 'O' && (m_read_begin < m_read_end || have_to_read())) {
+                    m_state = State::SS3;
                 } else {
                     add_event(KEYS::ESCAPE);
                     m_state = State::NORMAL;
@@ -170,41 +335,31 @@ void Input::process_input() {
                 }
                 break;
             case State::CSI:
-                if (m_buffer.empty()) {
-                    if (byte == 'A') {
-                        add_event(KEYS::UP);
-                        m_state = State::NORMAL;
-                    } else if (byte == 'B') {
-                        add_event(KEYS::DOWN);
-                        m_state = State::NORMAL;
-                    } else if (byte == 'C') {
-                        add_event(KEYS::RIGHT);
-                        m_state = State::NORMAL;
-                    } else if (byte == 'D') {
-                        add_event(KEYS::LEFT);
-                        m_state = State::NORMAL;
-                    } else if (byte == '<') {
-                        m_state = State::MOUSE;
-                    } else if (byte == '2') {
-                        m_buffer += byte;
-                    } else {
-                        // Unknown CSI, reset
-                        m_state = State::NORMAL;
-                    }
-                } else {
-                    // In '2...' sequence
+                if (m_buffer.empty() && byte == '<') {
+                    m_state = State::MOUSE;
+                } else if (m_buffer.empty() && byte == '?') {
+                    m_state = State::REPORT;
+                } else if (byte >= '@' && byte <= '~') {
+                    process_csi(byte);
+                    m_buffer.clear();
+                } else if (m_buffer.size() < 32) {
+                    // Parameters and intermediate bytes
                     m_buffer += byte;
-                    if (m_buffer == "2~") {
-                        add_event(KEYS::INSERT);
-                        m_buffer.clear();
-                        m_state = State::NORMAL;
-                    } else if (m_buffer == "200~") {
-                        m_buffer.clear();
-                        m_state = State::PASTE_CONTENT;
-                    } else if (m_buffer.size() > 4) {
-                        m_buffer.clear();
-                        m_state = State::NORMAL;
-                    }
+                } else {
+                    m_buffer.clear();
+                    m_state = State::NORMAL;
+                }
+                break;
+            case State::SS3:
+                // F1-F4, home and end of the terminals that send them as ESC O
+                m_state = State::NORMAL;
+                if (byte == 'P' || byte == 'Q' || byte == 'R' || byte == 'S' || byte == 'H' || byte == 'F') {
+                    m_buffer.clear();
+                    process_csi(byte);
+                } else {
+                    add_event(KEYS::ESCAPE);
+                    add_event('O');
+                    handle_key(byte);
                 }
                 break;
             case State::MOUSE:
@@ -215,11 +370,34 @@ void Input::process_input() {
                     m_state = State::NORMAL;
                 }
                 break;
-            case State::PASTE_CONTENT:
+            case State::REPORT:
+                // Replies of the terminal run until the final byte of the CSI sequence
                 m_buffer += byte;
-                if (m_buffer.size() >= 6 && m_buffer.compare(m_buffer.size() - 6, 6, "\033[201~") == 0) {
-                    std::string content = m_buffer.substr(0, m_buffer.size() - 6);
-                    add_event(std::string_view(content));
+                if (byte >= '@' && byte <= '~') {
+                    process_report();
+                    m_buffer.clear();
+                    m_state = State::NORMAL;
+                } else if (m_buffer.size() > 32) {
+                    m_buffer.clear();
+                    m_state = State::NORMAL;
+                }
+                break;
+            case State::DCS:
+                // Terminal replies start with "1+r" or "0+r", anything else was alt+P followed by other keys
+                if (m_buffer.empty() && byte != '0' && byte != '1') {
+                    add_event(KEYS::ESCAPE);
+                    add_event('P');
+                    m_state = State::NORMAL;
+                    handle_key(byte);
+                    break;
+                }
+                m_buffer += byte;
+                if (m_buffer.ends_with("\033\\")) {
+                    m_buffer.resize(m_buffer.size() - 2);
+                    process_device_control();
+                    m_buffer.clear();
+                    m_state = State::NORMAL;
+                } else if (m_buffer.size() > 256) {
                     m_buffer.clear();
                     m_state = State::NORMAL;
                 }
@@ -230,14 +408,225 @@ void Input::process_input() {
         }
     }
 
+    if (!m_kitty_keyboard) {
+        // A key still down from the previous frame that was received again is not released
+        m_keys.released &= ~m_keys.down;
+        m_characters.released &= ~m_characters.down;
+    }
+
 #ifdef DEBUG
-    debug_msg("Input events: " << m_events.size());
+    log_msg(LogCategory::INPUT, LogLevel::INFO, "Input events: " << m_events.size());
     for (auto &event : m_events) {
-        debug_msg(event);
+        log_msg(LogCategory::INPUT, LogLevel::INFO, event);
     }
 #endif
 }
 
+void Input::add_paste_chunk(std::string_view text, bool last) {
+    add_event(PasteEvent{m_arena.store(text), m_paste_first, last});
+    m_paste_first = false;
+}
+
+// Consumes paste content from the read buffer in bulk, delivering at most `budget` bytes as a paste chunk. Returns the
+// number of paste bytes delivered.
+size_t Input::process_paste(size_t budget) {
+    static constexpr std::string_view END_MARKER = "\033[201~";
+
+    if (!m_buffer.empty()) {
+        // The previous read ended with a partial end marker, keep matching it byte by byte
+        m_buffer += m_read_buffer[m_read_begin++];
+        if (m_buffer == END_MARKER) {
+            m_buffer.clear();
+            add_paste_chunk({}, true);
+            m_state = State::NORMAL;
+            return 0;
+        }
+        if (END_MARKER.starts_with(m_buffer)) {
+            return 0;
+        }
+        // It was content after all, the new byte is scanned again as it could start the marker
+        m_read_begin--;
+        m_buffer.pop_back();
+        const size_t size = m_buffer.size();
+        add_paste_chunk(m_buffer, false);
+        m_buffer.clear();
+        return size;
+    }
+
+    const char *data = m_read_buffer + m_read_begin;
+    const char *end = m_read_buffer + m_read_end;
+    // memchr is vectorized, so the content is skipped in bulk up to each ESC and only there the marker is compared
+    const char *marker = nullptr;
+    const char *partial_marker = nullptr;
+    const char *search = data;
+    while (search < end) {
+        const char *esc = static_cast<const char *>(std::memchr(search, '\033', end - search));
+        if (esc == nullptr) break;
+        const size_t remaining = end - esc;
+        if (remaining >= END_MARKER.size()) {
+            if (std::memcmp(esc, END_MARKER.data(), END_MARKER.size()) == 0) {
+                marker = esc;
+                break;
+            }
+        } else if (END_MARKER.starts_with(std::string_view(esc, remaining))) {
+            partial_marker = esc;
+            break;
+        }
+        search = esc + 1;
+    }
+
+    const char *content_end = marker ? marker : (partial_marker ? partial_marker : end);
+    const size_t content_size = content_end - data;
+    if (content_size > budget) {
+        add_paste_chunk(std::string_view(data, budget), false);
+        m_read_begin += budget;
+        return budget;
+    }
+
+    if (marker) {
+        add_paste_chunk(std::string_view(data, content_size), true);
+        m_read_begin += content_size + END_MARKER.size();
+        m_state = State::NORMAL;
+    } else {
+        if (content_size > 0) {
+            add_paste_chunk(std::string_view(data, content_size), false);
+        }
+        if (partial_marker) {
+            m_buffer.assign(partial_marker, end);
+        }
+        m_read_begin = m_read_end;
+    }
+    return content_size;
+}
+
+// Parses a key sent as a CSI sequence, "number;modifiers:event;text" with every part optional. The legacy sequences
+// are the same without the event and the text, and the kitty protocol adds the "u" final byte for the keys that have a
+// code point. The state goes back to NORMAL unless it is the start of a paste.
+void Input::process_csi(char final_byte) {
+    m_state = State::NORMAL;
+    if (m_buffer.find_first_not_of("0123456789;:") != std::string::npos) {
+        // Intermediate bytes or private markers, not a key
+        return;
+    }
+    // The first sub-parameter of every field, and the second one of the modifiers, which is the event type
+    std::string_view fields[3];
+    std::string_view rest(m_buffer);
+    for (std::string_view &field : fields) {
+        const size_t semicolon = rest.find(';');
+        field = rest.substr(0, semicolon);
+        rest = semicolon == std::string_view::npos ? std::string_view() : rest.substr(semicolon + 1);
+    }
+    const auto parse = [](std::string_view field, size_t sub_parameter, int default_value) {
+        for (size_t i = 0; i < sub_parameter && !field.empty(); i++) {
+            const size_t colon = field.find(':');
+            field = colon == std::string_view::npos ? std::string_view() : field.substr(colon + 1);
+        }
+        field = field.substr(0, field.find(':'));
+        int value = default_value;
+        if (!field.empty()) std::from_chars(field.data(), field.data() + field.size(), value);
+        return value;
+    };
+    const int number = parse(fields[0], 0, 1);
+    // The lock bits (Caps Lock 64, Num Lock 128, hyper and meta) are dropped, so the modifiers compare equal whatever
+    // locks are on
+    const uint8_t modifiers = static_cast<uint8_t>(std::max(parse(fields[1], 0, 1) - 1, 0)) & MODIFIERS_MASK;
+    const int event = parse(fields[1], 1, 1);
+    const KEY_ACTION action = event == 3 ? KEY_ACTION::RELEASED : event == 2 ? KEY_ACTION::REPEATED : KEY_ACTION::PRESSED;
+
+    if (final_byte == '~') {
+        if (number == 200) {
+            m_paste_first = true;
+            m_state = State::PASTE_CONTENT;
+            return;
+        }
+        for (const auto &[code, key] : TILDE_KEYS) {
+            if (code == number) add_key_event(key, '\0', action, modifiers);
+        }
+    } else if (final_byte == 'u') {
+        process_kitty_key(number, parse(fields[2], 0, 0), action, modifiers);
+    } else {
+        for (const auto &[code, key] : LETTER_KEYS) {
+            if (code == final_byte) add_key_event(key, '\0', action, modifiers);
+        }
+    }
+}
+
+// The number is the unshifted code point of the key and the text what it types, only sent on press and repeat
+void Input::process_kitty_key(int number, int text, KEY_ACTION action, uint8_t modifiers) {
+    if (number > ' ' && number < 127) {
+        char character;
+        if (action == KEY_ACTION::RELEASED) {
+            character = m_kitty_characters[number] ? m_kitty_characters[number] : static_cast<char>(number);
+        } else {
+            character = text > ' ' && text < 127 ? static_cast<char>(text) : static_cast<char>(number);
+            m_kitty_characters[number] = character;
+        }
+        add_key_event(KEYS::CHARACTER, character, action, modifiers);
+        // Ctrl+C is no longer a signal once the terminal sends it as a key, it still interrupts the process
+        if (number == 'c' && modifiers == MODIFIER_CTRL && action == KEY_ACTION::PRESSED && m_fd == STDIN_FILENO) {
+            std::raise(SIGINT);
+        }
+        return;
+    }
+    for (const auto &[code, key] : KITTY_KEYS) {
+        if (code == number) add_key_event(key, '\0', action, modifiers);
+    }
+}
+
+void Input::add_key_event(KEYS key, char character, KEY_ACTION action, uint8_t modifiers) {
+    add_event(KeyboardEvent{key, character, action, modifiers});
+}
+
+// Parses the buffer accumulated in REPORT state, the replies to the capability queries
+void Input::process_report() {
+    std::string_view report(m_buffer);
+    TerminalReport terminal_report = {};
+    if (report.ends_with("$y")) {
+        terminal_report.type = TerminalReport::type_t::Mode;
+        report.remove_suffix(2);
+    } else if (report.ends_with('u')) {
+        terminal_report.type = TerminalReport::type_t::KeyboardFlags;
+        report.remove_suffix(1);
+    } else if (report.ends_with('c')) {
+        terminal_report.type = TerminalReport::type_t::DeviceAttributes;
+        report.remove_suffix(1);
+    } else {
+        return;
+    }
+
+    // The parameters are "first;second...", the kitty flags are a single one
+    const size_t semicolon = report.find(';');
+    const std::string_view first = report.substr(0, semicolon);
+    if (std::from_chars(first.data(), first.data() + first.size(), terminal_report.mode).ec != std::errc()) return;
+    if (terminal_report.type == TerminalReport::type_t::Mode) {
+        if (semicolon == std::string_view::npos) return;
+        const std::string_view second = report.substr(semicolon + 1);
+        if (std::from_chars(second.data(), second.data() + second.size(), terminal_report.value).ec != std::errc()) {
+            return;
+        }
+    } else {
+        terminal_report.value = terminal_report.mode;
+    }
+    m_reports.push_back(terminal_report);
+}
+
+// Parses the buffer accumulated in DCS state, only the XTGETTCAP replies ("1+r<hex name>=<hex value>") are used
+void Input::process_device_control() {
+    std::string_view reply(m_buffer);
+    if (reply.size() < 3 || reply.substr(1, 2) != "+r") return;
+    // The name is hex encoded, so the reply of every query is told apart whatever order they arrive in
+    std::string_view hex = reply.substr(3);
+    hex = hex.substr(0, hex.find('='));
+    if (hex.size() % 2 != 0) return;
+    std::string name;
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        unsigned int byte = 0;
+        if (std::from_chars(hex.data() + i, hex.data() + i + 2, byte, 16).ptr != hex.data() + i + 2) return;
+        name += static_cast<char>(byte);
+    }
+    m_reports.push_back({TerminalReport::type_t::Capability, capability_id(name), reply[0] == '1' ? 1 : 0});
+}
+
 // Parses the buffer accumulated in MOUSE state
 void Input::process_mouse_input() {
     if (m_buffer.empty()) return;
@@ -295,54 +684,6 @@ void Input::process_mouse_input() {
     mouseEvent.position.x -= 1;
     mouseEvent.position.y -= 1;
     add_event(mouseEvent);
-    m_mouse_position = mouseEvent.position;
-    m_mouse_state[static_cast<int>(mouseEvent.button)] = mouseEvent.action;
 }
 
-bool Input::is_key_pressed(char c) {
-    for (auto &event : m_events) {
-        if (event.type == InputEvent::type_t::Keyboard && event.as.keyboardEvent.key == KEYS::CHARACTER &&
-            event.as.keyboardEvent.character == c) {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool Input::is_key_pressed(KEYS key) {
-    for (auto &event : m_events) {
-        if (event.type == InputEvent::type_t::Keyboard && event.as.keyboardEvent.key == key) {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool Input::is_mouse_pressed(MOUSE_BUTTONS button) {
-    return m_mouse_state[static_cast<int>(button)] == MOUSE_ACTION::PRESSED;
-}
-
-bool Input::is_mouse_released(MOUSE_BUTTONS button) {
-    return m_mouse_state[static_cast<int>(button)] == MOUSE_ACTION::RELEASED;
-}
-
-MousePosition Input::get_mouse_position() { return m_mouse_position; }
-
-bool Input::is_scroll_down() {
-    for (auto &event : m_events) {
-        if (event.type == InputEvent::type_t::Mouse && event.as.mouseEvent.button == MOUSE_BUTTONS::WHEEL_DOWN) {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool Input::is_scroll_up() {
-    for (auto &event : m_events) {
-        if (event.type == InputEvent::type_t::Mouse && event.as.mouseEvent.button == MOUSE_BUTTONS::WHEEL_UP) {
-            return true;
-        }
-    }
-    return false;
-}
-}  // namespace TUIE
\ No newline at end of file
+}  // namespace TUIE
@@ -1,12 +1,19 @@
 #pragma once
 
-#include <array>
-#include <cstring>
+#include <bitset>
+#include <cstdint>
 #include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "Arena.hpp"
+
 namespace TUIE {
 
+class Recorder;
+
 enum class KEYS {
     NONE,
     CHARACTER,
@@ -38,6 +45,7 @@ enum class KEYS {
     F10,
     F11,
     F12,
+    SIZE,
 };
 std::ostream &operator<<(std::ostream &os, const KEYS &key);
 
@@ -61,9 +69,29 @@ enum class MOUSE_ACTION {
 };
 std::ostream &operator<<(std::ostream &os, const MOUSE_ACTION &action);
 
+enum class KEY_ACTION {
+    PRESSED,
+    REPEATED,
+    RELEASED,
+};
+std::ostream &operator<<(std::ostream &os, const KEY_ACTION &action);
+
+// Bits of KeyboardEvent::modifiers
+enum KEY_MODIFIERS : uint8_t {
+    MODIFIER_SHIFT = 1,
+    MODIFIER_ALT = 2,
+    MODIFIER_CTRL = 4,
+    MODIFIER_SUPER = 8,
+    MODIFIERS_MASK = MODIFIER_SHIFT | MODIFIER_ALT | MODIFIER_CTRL | MODIFIER_SUPER,
+};
+
+// The legacy protocol only reports presses, and modifiers only for the keys sent as escape sequences. With the kitty
+// keyboard protocol (Input::set_kitty_keyboard) every key reports its modifiers, repeats and releases.
 struct KeyboardEvent {
     KEYS key;
     char character;
+    KEY_ACTION action;
+    uint8_t modifiers;
 
     friend std::ostream &operator<<(std::ostream &os, const KeyboardEvent &event);
 };
@@ -81,13 +109,45 @@ struct MouseEvent {
     friend std::ostream &operator<<(std::ostream &os, const MouseEvent &event);
 };
 
+// Bracketed pastes are streamed: a paste can arrive as several chunks over one or more frames, the first one flagged
+// with `first` and the last one with `last` (a paste that fits in one read is a single chunk with both set)
 struct PasteEvent {
-    const char *text;
-    size_t size;
+    // Points into the input arena, only valid until the events are cleared
+    std::string_view text;
+    bool first;
+    bool last;
 
     friend std::ostream &operator<<(std::ostream &os, const PasteEvent &event);
 };
 
+// Answer of the terminal to a query of Terminal, used to probe its capabilities (see Capabilities.hpp)
+struct TerminalReport {
+    enum class type_t {
+        // DECRPM (CSI ? mode ; value $ y): value 1 or 2 means the mode is known and set or reset, 0 that it is not
+        // recognized and 3 or 4 that it is permanently set or reset
+        Mode,
+        // Flags of the kitty keyboard protocol (CSI ? flags u), only terminals that support it answer
+        KeyboardFlags,
+        // Primary device attributes (CSI ? level ; ... c), every terminal answers it
+        DeviceAttributes,
+        // XTGETTCAP (DCS 1 + r name = value ST), value 1 when the terminfo capability exists and mode the
+        // capability_id of its name
+        Capability,
+    };
+    type_t type;
+    int mode;
+    int value;
+};
+
+// Id of a terminfo capability name in the XTGETTCAP reports (FNV-1a of the name)
+constexpr int capability_id(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (const char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return static_cast<int>(hash & 0x7FFFFFFF);
+}
+
 struct InputEvent {
     enum class type_t {
         Keyboard,
@@ -101,86 +161,126 @@ struct InputEvent {
         PasteEvent pasteEvent;
     } as;
 
-    InputEvent(KEYS key) : type(type_t::Keyboard), as({.keyboardEvent = {key, '\0'}}) {}
-    InputEvent(char c) : type(type_t::Keyboard), as({.keyboardEvent = {KEYS::CHARACTER, c}}) {}
+    InputEvent(KEYS key) : type(type_t::Keyboard), as({.keyboardEvent = {key, '\0', KEY_ACTION::PRESSED, 0}}) {}
+    InputEvent(char c) : type(type_t::Keyboard), as({.keyboardEvent = {KEYS::CHARACTER, c, KEY_ACTION::PRESSED, 0}}) {}
+    InputEvent(KeyboardEvent keyboardEvent) : type(type_t::Keyboard), as({.keyboardEvent = keyboardEvent}) {}
     InputEvent(MouseEvent mouseEvent) : type(type_t::Mouse), as({.mouseEvent = mouseEvent}) {}
-    InputEvent(std::string_view sv)
-        : type(type_t::Paste), as({.pasteEvent = {.text = ::strndup(sv.data(), sv.size()), .size = sv.size()}}) {}
+    InputEvent(PasteEvent pasteEvent) : type(type_t::Paste), as({.pasteEvent = pasteEvent}) {}
 
-    ~InputEvent() {
-        if (type == type_t::Paste) {
-            if (as.pasteEvent.text != nullptr) {
-                std::free(const_cast<char *>(as.pasteEvent.text));
-            }
-        }
-    }
-    // Copy and move contructors to take into account the Paste event pointer
-    InputEvent(const InputEvent &other) {
-        type = other.type;
-        switch (type) {
-            case type_t::Keyboard:
-                as.keyboardEvent = other.as.keyboardEvent;
-                break;
-            case type_t::Mouse:
-                as.mouseEvent = other.as.mouseEvent;
-                break;
-            case type_t::Paste:
-                as.pasteEvent = other.as.pasteEvent;
-                as.pasteEvent.text = ::strndup(other.as.pasteEvent.text, other.as.pasteEvent.size);
-                break;
-        }
-    }
-    InputEvent(InputEvent &&other) {
-        type = other.type;
-        switch (type) {
-            case type_t::Keyboard:
-                as.keyboardEvent = other.as.keyboardEvent;
-                break;
-            case type_t::Mouse:
-                as.mouseEvent = other.as.mouseEvent;
-                break;
-            case type_t::Paste:
-                as.pasteEvent = other.as.pasteEvent;
-                other.as.pasteEvent.text = nullptr;
-                other.as.pasteEvent.size = 0;
-                break;
-        }
-    }
     friend std::ostream &operator<<(std::ostream &os, const InputEvent &event);
 };
+// Events are copied around freely, they must not own memory
+static_assert(std::is_trivially_copyable_v<InputEvent>);
+
+struct KeyAwaiter;
 
 class Input {
+   public:
+    // Reads the terminal input from fd, which is left open
+    explicit Input(int fd) : m_fd(fd) {}
+
    public:
     void process_input();
     std::vector<InputEvent> &get_events() { return m_events; }
-    void clear_events() { m_events.clear(); }
+    // Starts a new frame: drops the events and the per-frame edges (pressed/released) of the state tables
+    void clear_events();
+    // When set, every raw byte read from the terminal is also handed to the recorder
+    void set_recorder(Recorder *recorder) { m_recorder = recorder; }
+    // Maximum paste bytes delivered per frame, the rest stays unread until the next frames. It bounds the memory used
+    // by a paste of any size.
+    void set_paste_limit(size_t bytes) { m_paste_limit = bytes > 0 ? bytes : 1; }
+    // The terminal sends kitty keyboard protocol events (engine::enable_kitty_keyboard pushes the flags). An ESC is
+    // then always the start of a sequence, so it is never told apart by timing, and the keys are down from their press
+    // to their release event instead of only on the frames they are received.
+    void set_kitty_keyboard(bool enable);
+    bool is_kitty_keyboard() const { return m_kitty_keyboard; }
+    // Replies to the queries of Terminal received this frame, they are not delivered as key events
+    const std::vector<TerminalReport> &get_reports() const { return m_reports; }
+    // Inside a task, co_await input.key() resumes with the next key press (see Scheduler.hpp)
+    KeyAwaiter key() const;
 
    public:
-    bool is_key_pressed(char c);
-    bool is_key_pressed(KEYS key);
-    bool is_key_released(KEYS key);
-    bool is_mouse_pressed(MOUSE_BUTTONS button);
-    bool is_mouse_released(MOUSE_BUTTONS button);
-    MousePosition get_mouse_position();
-    bool is_scroll_down();
-    bool is_scroll_up();
+    // pressed/released are true only on the frame the transition happened, down while it is held. The legacy terminal
+    // protocol has no key release events, so a key counts as down on the frames it is received and as released on the
+    // first frame it is not received anymore. With the kitty keyboard protocol they follow the real key.
+    bool is_key_pressed(char c) const { return m_characters.pressed[static_cast<unsigned char>(c)]; }
+    bool is_key_pressed(KEYS key) const { return m_keys.pressed[static_cast<int>(key)]; }
+    // Presses of this frame counting the auto-repeats, for actions that step once per key stroke like scrolling
+    int get_key_presses(char c) const;
+    int get_key_presses(KEYS key) const;
+    bool is_key_down(char c) const { return m_characters.down[static_cast<unsigned char>(c)]; }
+    bool is_key_down(KEYS key) const { return m_keys.down[static_cast<int>(key)]; }
+    bool is_key_released(char c) const { return m_characters.released[static_cast<unsigned char>(c)]; }
+    bool is_key_released(KEYS key) const { return m_keys.released[static_cast<int>(key)]; }
+    bool is_mouse_pressed(MOUSE_BUTTONS button) const { return m_mouse.pressed[static_cast<int>(button)]; }
+    bool is_mouse_down(MOUSE_BUTTONS button) const { return m_mouse.down[static_cast<int>(button)]; }
+    bool is_mouse_released(MOUSE_BUTTONS button) const { return m_mouse.released[static_cast<int>(button)]; }
+    MousePosition get_mouse_position() const { return m_mouse_position; }
+    // Wheel steps of this frame, positive when scrolling down
+    int get_scroll_delta() const { return m_scroll_down - m_scroll_up; }
+    bool is_scroll_down() const { return m_scroll_down > 0; }
+    bool is_scroll_up() const { return m_scroll_up > 0; }
 
    private:
-    int get_byte();
     bool have_to_read();
-    void add_event(InputEvent event) { m_events.push_back(event); }
+    bool fill_read_buffer();
+    size_t process_paste(size_t budget);
+    void add_paste_chunk(std::string_view text, bool last);
+    void add_event(const InputEvent &event);
     void process_mouse_input();
+    void process_report();
+    void process_device_control();
+    void process_csi(char final_byte);
+    void process_kitty_key(int number, int text, KEY_ACTION action, uint8_t modifiers);
+    void add_key_event(KEYS key, char character, KEY_ACTION action, uint8_t modifiers);
     void handle_key(char byte);
 
    private:
-    MousePosition m_mouse_position;
-    std::array<MOUSE_ACTION, static_cast<int>(MOUSE_BUTTONS::SIZE)> m_mouse_state;
+    template <size_t N>
+    struct StateTable {
+        std::bitset<N> pressed;
+        std::bitset<N> down;
+        std::bitset<N> released;
+
+        // Only the transition to down counts as a press, a repeat of a key already held just keeps it down
+        void press(size_t index, bool repeat = false) {
+            if (!repeat && !down.test(index)) {
+                pressed.set(index);
+            }
+            down.set(index);
+        }
+        void release(size_t index) {
+            released.set(index);
+            down.reset(index);
+        }
+    };
+
+    int m_fd;
+    MousePosition m_mouse_position = {0, 0};
+    StateTable<static_cast<int>(KEYS::SIZE)> m_keys;
+    StateTable<256> m_characters;
+    StateTable<static_cast<int>(MOUSE_BUTTONS::SIZE)> m_mouse;
+    int m_scroll_up = 0;
+    int m_scroll_down = 0;
     std::vector<InputEvent> m_events;
+    std::vector<TerminalReport> m_reports;
+    // Storage for the event payloads (paste text) of the current frame
+    Arena m_arena;
+    Recorder *m_recorder = nullptr;
 
-    enum class State { NORMAL, ESC, CSI, MOUSE, PASTE_START, PASTE_CONTENT, PASTE_END };
+    enum class State { NORMAL, ESC, CSI, SS3, MOUSE, REPORT, DCS, PASTE_START, PASTE_CONTENT, PASTE_END };
 
     State m_state = State::NORMAL;
     std::string m_buffer;
+
+    char m_read_buffer[4096];
+    size_t m_read_begin = 0;
+    size_t m_read_end = 0;
+    size_t m_paste_limit = 1 << 20;
+    bool m_paste_first = false;
+    bool m_kitty_keyboard = false;
+    // The character each key code (ASCII) was pressed as, its release carries the unshifted key code only
+    char m_kitty_characters[128] = {};
 };
 
 }  // namespace TUIE
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "LineIndex.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace TUIE {
+
+LineIndex::LineIndex(std::string_view data) : m_data(data) {
+    m_thread = std::jthread([this](std::stop_token stop_token) { build(stop_token); });
+}
+
+LineIndex::~LineIndex() {
+    m_thread.request_stop();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void LineIndex::build(std::stop_token stop_token) {
+    scan(0, stop_token);
+    if (!stop_token.stop_requested()) {
+        finish();
+    }
+}
+
+void LineIndex::scan(uint64_t from, std::stop_token stop_token) {
+    // The data is scanned in chunks with memchr (vectorized in libc), publishing the checkpoints of each chunk
+    constexpr size_t CHUNK_SIZE = 4 << 20;
+    const char* const begin = m_data.data();
+    const char* const end = begin + m_data.size();
+    std::vector<uint64_t> checkpoints;
+    size_t line_count = m_line_count;
+    uint64_t line_start = m_next_line_start;
+
+    for (const char* chunk = begin + from; chunk < end && !stop_token.stop_requested(); chunk += CHUNK_SIZE) {
+        const char* chunk_end = std::min(chunk + CHUNK_SIZE, end);
+        checkpoints.clear();
+        for (const char* it = chunk; it < chunk_end;) {
+            const char* newline = static_cast<const char*>(std::memchr(it, '\n', chunk_end - it));
+            if (newline == nullptr) break;
+            if (line_count % CHECKPOINT_LINES == 0) {
+                checkpoints.push_back(line_start);
+            }
+            line_count++;
+            line_start = newline + 1 - begin;
+            it = newline + 1;
+        }
+        std::lock_guard lock(m_mutex);
+        m_checkpoints.insert(m_checkpoints.end(), checkpoints.begin(), checkpoints.end());
+        m_line_count = line_count;
+        m_next_line_start = line_start;
+        m_indexed_size = line_start;
+    }
+}
+
+void LineIndex::finish() {
+    std::lock_guard lock(m_mutex);
+    // A last line without newline is a line too
+    if (m_next_line_start < m_data.size()) {
+        if (m_line_count % CHECKPOINT_LINES == 0) {
+            m_checkpoints.push_back(m_next_line_start);
+        }
+        m_line_count++;
+        m_partial_line = true;
+    }
+    m_indexed_size = m_data.size();
+    m_complete = true;
+}
+
+void LineIndex::append(std::string_view data) {
+    const uint64_t old_size = m_data.size();
+    {
+        std::lock_guard lock(m_mutex);
+        m_data = data;
+        m_complete = false;
+        if (m_partial_line) {
+            // The unterminated last line is counted again by scan() once its newline is found
+            m_line_count--;
+            if (m_line_count % CHECKPOINT_LINES == 0) {
+                m_checkpoints.pop_back();
+            }
+            m_partial_line = false;
+        }
+    }
+    // There are no newlines between the last line start and the old end, so only the new bytes are scanned
+    scan(old_size);
+    finish();
+}
+
+void LineIndex::reset(std::string_view data) {
+    m_thread.request_stop();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        m_data = data;
+        m_checkpoints.clear();
+        m_line_count = 0;
+        m_next_line_start = 0;
+        m_indexed_size = 0;
+        m_partial_line = false;
+        m_complete = false;
+    }
+    m_thread = std::jthread([this](std::stop_token stop_token) { build(stop_token); });
+}
+
+size_t LineIndex::line_count() const {
+    std::lock_guard lock(m_mutex);
+    return m_line_count;
+}
+
+bool LineIndex::is_complete() const {
+    std::lock_guard lock(m_mutex);
+    return m_complete;
+}
+
+uint64_t LineIndex::indexed_size() const {
+    std::lock_guard lock(m_mutex);
+    return m_indexed_size;
+}
+
+uint64_t LineIndex::line_start(size_t line) const {
+    uint64_t start;
+    {
+        std::lock_guard lock(m_mutex);
+        start = m_checkpoints[line / CHECKPOINT_LINES];
+    }
+    for (size_t i = 0; i < line % CHECKPOINT_LINES; i++) {
+        const char* newline =
+            static_cast<const char*>(std::memchr(m_data.data() + start, '\n', m_data.size() - start));
+        // Only possible if the data changed under the index (a truncated file not reloaded yet)
+        if (newline == nullptr) return m_data.size();
+        start = newline + 1 - m_data.data();
+    }
+    return start;
+}
+
+std::string_view LineIndex::line(size_t line) const {
+    const uint64_t start = line_start(line);
+    const char* newline = static_cast<const char*>(std::memchr(m_data.data() + start, '\n', m_data.size() - start));
+    const uint64_t end = newline ? newline - m_data.data() : m_data.size();
+    std::string_view text = m_data.substr(start, end - start);
+    if (!text.empty() && text.back() == '\r') {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+size_t LineIndex::line_of_offset(uint64_t offset) const {
+    size_t checkpoint;
+    uint64_t start;
+    size_t line_count;
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), offset);
+        if (it == m_checkpoints.begin()) return 0;
+        checkpoint = it - m_checkpoints.begin() - 1;
+        start = m_checkpoints[checkpoint];
+        line_count = m_line_count;
+    }
+    size_t line = checkpoint * CHECKPOINT_LINES;
+    while (line + 1 < line_count) {
+        const char* newline =
+            static_cast<const char*>(std::memchr(m_data.data() + start, '\n', m_data.size() - start));
+        if (newline == nullptr || static_cast<uint64_t>(newline - m_data.data()) >= offset) break;
+        start = newline + 1 - m_data.data();
+        line++;
+    }
+    return line;
+}
+
+}  // namespace TUIE
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace TUIE {
+
+// Newline index of a text buffer (usually a MappedFile) built on a background thread. Only the start of every
+// CHECKPOINT_LINES-th line is stored, the lines in between are found with memchr from the closest checkpoint. That
+// keeps the index a few MB for multi-GB files while any line is still reached in constant time.
+class LineIndex {
+   public:
+    static constexpr size_t CHECKPOINT_LINES = 64;
+
+    explicit LineIndex(std::string_view data);
+    ~LineIndex();
+    LineIndex(const LineIndex&) = delete;
+    LineIndex& operator=(const LineIndex&) = delete;
+
+   public:
+    // Data that extends the indexed one (a file that grew), only the new bytes are scanned. Requires is_complete().
+    void append(std::string_view data);
+    // Unrelated data (a file truncated or replaced), it is indexed again from scratch in the background
+    void reset(std::string_view data);
+
+   public:
+    // Number of lines indexed so far, it grows until is_complete()
+    size_t line_count() const;
+    bool is_complete() const;
+    // Bytes of data covered by the lines indexed so far
+    uint64_t indexed_size() const;
+    // The line without its newline (nor a trailing '\r'), line must be < line_count()
+    std::string_view line(size_t line) const;
+    // Line that contains the byte at offset
+    size_t line_of_offset(uint64_t offset) const;
+
+   private:
+    void build(std::stop_token stop_token);
+    void scan(uint64_t from, std::stop_token stop_token = {});
+    void finish();
+    uint64_t line_start(size_t line) const;
+
+   private:
+    std::string_view m_data;
+    mutable std::mutex m_mutex;
+    std::vector<uint64_t> m_checkpoints;
+    size_t m_line_count = 0;
+    // Start of the line after the last newline found
+    uint64_t m_next_line_start = 0;
+    uint64_t m_indexed_size = 0;
+    // The last line has no newline yet, it is counted but will be extended by append()
+    bool m_partial_line = false;
+    bool m_complete = false;
+    std::jthread m_thread;
+};
+
+}  // namespace TUIE
@@ -0,0 +1,170 @@
+#include "Logger.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+namespace TUIE {
+
+namespace {
+
+constexpr std::string_view CATEGORY_NAMES[] = {"general", "engine", "input", "render"};
+constexpr std::string_view LEVEL_NAMES[] = {"verbose", "info", "warning", "error", "off"};
+static_assert(std::size(CATEGORY_NAMES) == static_cast<size_t>(LogCategory::SIZE));
+
+// Writes into the claimed slot, the text past its end is dropped
+struct SlotBuffer : std::streambuf {
+    void reset(char* begin, size_t size) { setp(begin, begin + size); }
+    size_t size() const { return pptr() - pbase(); }
+    int_type overflow([[maybe_unused]] int_type c) override { return traits_type::eof(); }
+};
+
+struct ThreadStream {
+    SlotBuffer buffer;
+    std::ostream stream{&buffer};
+    // Where the messages go while the ring is full
+    char discard[Logger::TEXT_SIZE];
+};
+
+ThreadStream& thread_stream() {
+    thread_local ThreadStream stream;
+    return stream;
+}
+
+}  // namespace
+
+Logger& Logger::instance() {
+    static Logger* instance = new Logger();
+    return *instance;
+}
+
+Logger::Logger() : m_slots(new Slot[CAPACITY]) {
+    for (size_t i = 0; i < CAPACITY; i++) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    if (const char* levels = std::getenv("TUIE_LOG")) {
+        parse_levels(levels);
+    }
+    // Because is a TUI the messages can mess up the display, so they go to a file instead of cerr
+    m_file = std::fopen("debug.txt", "w");
+    m_thread = std::jthread([this](std::stop_token stop) { run(stop); });
+    std::atexit([]() { instance().finish(); });
+}
+
+void Logger::parse_levels(const char* levels) {
+    std::string_view rest(levels);
+    while (!rest.empty()) {
+        const size_t comma = rest.find(',');
+        const std::string_view entry = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+
+        const size_t equals = entry.find('=');
+        if (equals == std::string_view::npos) continue;
+        for (size_t category = 0; category < std::size(CATEGORY_NAMES); category++) {
+            if (CATEGORY_NAMES[category] != entry.substr(0, equals)) continue;
+            for (size_t level = 0; level < std::size(LEVEL_NAMES); level++) {
+                if (LEVEL_NAMES[level] == entry.substr(equals + 1)) {
+                    set_level(static_cast<LogCategory>(category), static_cast<LogLevel>(level));
+                }
+            }
+        }
+    }
+}
+
+Logger::Slot* Logger::claim() {
+    // Bounded MPMC queue of Vyukov, the sequence of a slot tells whether it is free for the position
+    size_t position = m_head.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = m_slots[position % CAPACITY];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (difference == 0) {
+            if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &slot;
+            }
+        } else if (difference < 0) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::publish(Slot* slot, size_t length) {
+    slot->length = static_cast<uint16_t>(length);
+    // The slot of position p is free at sequence p and ready to read at p + 1
+    slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void Logger::run(std::stop_token stop) {
+    while (!stop.stop_requested()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        write_messages();
+    }
+}
+
+void Logger::write_messages() {
+    m_batch.clear();
+    while (true) {
+        Slot& slot = m_slots[m_tail % CAPACITY];
+        if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1) break;
+
+        char header[64];
+        const int header_size =
+            std::snprintf(header, sizeof(header), "[%" PRId64 ".%06" PRId64 "] %s %s: ", slot.timestamp_ns / 1000000000,
+                          slot.timestamp_ns % 1000000000 / 1000, CATEGORY_NAMES[static_cast<int>(slot.category)].data(),
+                          LEVEL_NAMES[static_cast<int>(slot.level)].data());
+        m_batch.append(header, header_size);
+        m_batch.append(slot.text, slot.length);
+        m_batch += '\n';
+
+        slot.sequence.store(m_tail + CAPACITY, std::memory_order_release);
+        m_tail++;
+    }
+    if (m_file && !m_batch.empty()) {
+        std::fwrite(m_batch.data(), 1, m_batch.size(), m_file);
+        std::fflush(m_file);
+    }
+}
+
+void Logger::finish() {
+    m_thread.request_stop();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    write_messages();
+    if (m_file) {
+        if (const uint64_t dropped = get_dropped()) {
+            std::fprintf(m_file, "%" PRIu64 " messages dropped while the log was full\n", dropped);
+        }
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+LogMessage::LogMessage(LogCategory category, LogLevel level) : m_slot(Logger::instance().claim()) {
+    ThreadStream& thread = thread_stream();
+    if (m_slot) {
+        m_slot->timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count();
+        m_slot->category = category;
+        m_slot->level = level;
+        thread.buffer.reset(m_slot->text, Logger::TEXT_SIZE);
+    } else {
+        thread.buffer.reset(thread.discard, Logger::TEXT_SIZE);
+    }
+    thread.stream.clear();
+    m_stream = &thread.stream;
+}
+
+LogMessage::~LogMessage() {
+    if (m_slot) {
+        Logger::instance().publish(m_slot, thread_stream().buffer.size());
+    }
+}
+
+}  // namespace TUIE
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+namespace TUIE {
+
+enum class LogCategory : uint8_t {
+    GENERAL,
+    ENGINE,
+    INPUT,
+    RENDER,
+    SIZE,
+};
+
+// The names avoid DEBUG and TRACE, which are the build flags
+enum class LogLevel : uint8_t {
+    VERBOSE,
+    INFO,
+    WARNING,
+    ERROR,
+    OFF,
+};
+
+// Asynchronous logger behind the debug macros (debug.hpp). Producers format straight into a preallocated slot of a
+// lock-free MPSC ring and a background thread batches the slots into debug.txt, so logging never waits on the file.
+// The messages are truncated to the slot size and dropped (then counted) while the ring is full.
+//
+// The level of every category is set at runtime with set_level or with the TUIE_LOG environment variable, for
+// example TUIE_LOG=render=verbose,input=warning. Everything starts at INFO.
+class Logger {
+   public:
+    static constexpr size_t CAPACITY = 4096;
+    static constexpr size_t TEXT_SIZE = 240;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        int64_t timestamp_ns;
+        LogCategory category;
+        LogLevel level;
+        uint16_t length;
+        char text[TEXT_SIZE];
+    };
+
+    // Never destroyed, any thread can still log while the process exits. The last messages are written at exit.
+    static Logger& instance();
+
+    static bool is_enabled(LogCategory category, LogLevel level) {
+        return level >= s_levels[static_cast<int>(category)].load(std::memory_order_relaxed);
+    }
+    static void set_level(LogCategory category, LogLevel level) {
+        s_levels[static_cast<int>(category)].store(level, std::memory_order_relaxed);
+    }
+
+   public:
+    // A free slot to format into, nullptr when the ring is full
+    Slot* claim();
+    void publish(Slot* slot, size_t length);
+    uint64_t get_dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+   private:
+    Logger();
+    void run(std::stop_token stop);
+    void write_messages();
+    void finish();
+    void parse_levels(const char* levels);
+
+   private:
+    inline static std::atomic<LogLevel> s_levels[static_cast<int>(LogCategory::SIZE)] = {
+        LogLevel::INFO, LogLevel::INFO, LogLevel::INFO, LogLevel::INFO};
+
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<size_t> m_head = 0;
+    alignas(64) size_t m_tail = 0;
+    std::atomic<uint64_t> m_dropped = 0;
+    std::FILE* m_file = nullptr;
+    std::string m_batch;
+    std::jthread m_thread;
+};
+
+// One message: claims a slot and formats into it through a per-thread stream, the slot is published when it goes out
+// of scope. The stream is reused so a message costs no allocation.
+class LogMessage {
+   public:
+    LogMessage(LogCategory category, LogLevel level);
+    ~LogMessage();
+    LogMessage(const LogMessage&) = delete;
+    LogMessage& operator=(const LogMessage&) = delete;
+
+    std::ostream& stream() { return *m_stream; }
+
+   private:
+    Logger::Slot* m_slot;
+    std::ostream* m_stream;
+};
+
+}  // namespace TUIE
@@ -0,0 +1,155 @@
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace TUIE {
+
+namespace {
+
+// A file truncated by another process while it is mapped raises SIGBUS when the pages past the new end are read.
+// The handler maps zero pages there instead, so readers see zeros until the owner notices the change and reloads.
+struct MappedRange {
+    std::atomic<uintptr_t> begin{0};
+    std::atomic<uintptr_t> end{0};
+};
+MappedRange g_mapped_ranges[32];
+// Read by the handler, which can only call async-signal-safe functions, so they are set up before any range exists
+uintptr_t g_page_size = 0;
+struct sigaction g_previous_action;
+
+void handle_sigbus(int signal, siginfo_t* info, void* context) {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(info->si_addr);
+    for (const MappedRange& range : g_mapped_ranges) {
+        if (address >= range.begin.load() && address < range.end.load()) {
+            // mmap is a plain system call, it takes no lock the interrupted code could hold
+            void* page = reinterpret_cast<void*>(address & ~(g_page_size - 1));
+            if (mmap(page, g_page_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+                return;
+            }
+        }
+    }
+    // Not a mapped file, it belongs to whoever handled SIGBUS before
+    if (g_previous_action.sa_flags & SA_SIGINFO) {
+        g_previous_action.sa_sigaction(signal, info, context);
+    } else if (g_previous_action.sa_handler != SIG_DFL && g_previous_action.sa_handler != SIG_IGN) {
+        g_previous_action.sa_handler(signal);
+    } else {
+        // The fault happens again on return and crashes as usual (an ignored SIGBUS would only loop)
+        struct sigaction action = {};
+        action.sa_handler = SIG_DFL;
+        sigemptyset(&action.sa_mask);
+        sigaction(signal, &action, nullptr);
+    }
+}
+
+// False when every slot is taken, the range would not be protected
+bool register_range(const char* data, size_t size) {
+    static std::once_flag install_handler;
+    std::call_once(install_handler, []() {
+        g_page_size = sysconf(_SC_PAGESIZE);
+        struct sigaction action = {};
+        action.sa_sigaction = handle_sigbus;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGBUS, &action, &g_previous_action);
+    });
+    for (MappedRange& range : g_mapped_ranges) {
+        uintptr_t expected = 0;
+        if (range.begin.compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(data))) {
+            range.end.store(reinterpret_cast<uintptr_t>(data) + size);
+            return true;
+        }
+    }
+    return false;
+}
+
+void unregister_range(const char* data) {
+    for (MappedRange& range : g_mapped_ranges) {
+        if (range.begin.load() == reinterpret_cast<uintptr_t>(data)) {
+            range.end.store(0);
+            range.begin.store(0);
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path) : m_path(path) { map(); }
+
+MappedFile::~MappedFile() { unmap(); }
+
+void MappedFile::map() {
+    int fd = open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + m_path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        throw std::runtime_error("Could not stat file: " + m_path + ": " + std::strerror(errno));
+    }
+    // mmap does not accept empty mappings, an empty file is just an empty view
+    const char* mapped = nullptr;
+    if (st.st_size > 0) {
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Could not map file: " + m_path + ": " + std::strerror(errno));
+        }
+        // The file is read front to back by the indexer and then in the viewport neighbourhood
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        mapped = static_cast<const char*>(data);
+        if (!register_range(mapped, st.st_size)) {
+            munmap(data, st.st_size);
+            close(fd);
+            throw std::runtime_error("Too many mapped files to protect from truncation: " + m_path);
+        }
+    }
+    m_data = mapped;
+    m_size = st.st_size;
+    m_device = st.st_dev;
+    m_inode = st.st_ino;
+    close(fd);
+}
+
+void MappedFile::unmap() {
+    if (m_data) {
+        unregister_range(m_data);
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+
+MappedFile::Change MappedFile::reload() {
+    struct stat st;
+    // While a rotated file is not recreated yet the old mapping is still valid, keep showing it
+    if (stat(m_path.c_str(), &st) < 0) return Change::NONE;
+
+    Change change;
+    if (st.st_dev != m_device || st.st_ino != m_inode) {
+        change = Change::REPLACED;
+    } else if (static_cast<size_t>(st.st_size) > m_size) {
+        change = Change::GROWN;
+    } else if (static_cast<size_t>(st.st_size) < m_size) {
+        change = Change::TRUNCATED;
+    } else {
+        return Change::NONE;
+    }
+    unmap();
+    map();
+    return change;
+}
+
+}  // namespace TUIE
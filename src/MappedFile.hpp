@@ -0,0 +1,45 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <string>
+#include <string_view>
+
+namespace TUIE {
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+   public:
+    enum class Change { NONE, GROWN, TRUNCATED, REPLACED };
+
+   public:
+    // Throws when the file can not be mapped, or when 32 files are already mapped: every mapping is protected from a
+    // truncation of the file and the protection has a fixed number of slots
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+   public:
+    // Maps the file again if it changed on disk. Any view of the previous data is invalidated unless NONE is returned,
+    // and on GROWN the old contents are still a prefix of the new ones.
+    Change reload();
+
+   public:
+    std::string_view data() const { return std::string_view(m_data, m_size); }
+    size_t size() const { return m_size; }
+    const std::string& path() const { return m_path; }
+
+   private:
+    void map();
+    void unmap();
+
+   private:
+    std::string m_path;
+    dev_t m_device = 0;
+    ino_t m_inode = 0;
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+}  // namespace TUIE
@@ -0,0 +1,322 @@
+#include "Pager.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "TUIengine.hpp"
+#include "Utf8.hpp"
+
+namespace TUIE {
+
+Pager::Pager(const std::string& path) : m_file(path), m_index(m_file.data()), m_search(m_file.data()) {}
+
+Pager::~Pager() {
+    if (m_engine && m_watcher) {
+        m_engine->unwatch_fd(m_watcher->get_fd());
+    }
+}
+
+void Pager::follow(engine& engine) {
+    if (m_watcher) return;
+    m_watcher = std::make_unique<FileWatcher>(m_file.path());
+    m_engine = &engine;
+    m_scroll_to_bottom = true;
+    engine.watch_fd(m_watcher->get_fd(), [this]() {
+        if (m_watcher->read_events()) {
+            m_file_changed = true;
+            reload_file();
+        }
+    });
+}
+
+void Pager::reload_file() {
+    if (!m_file_changed || !m_index.is_complete()) return;
+    m_file_changed = false;
+
+    const bool at_bottom = m_index.line_count() == 0 || m_top >= bottom_position();
+    // Nothing can read the old mapping while it is replaced
+    m_search.cancel();
+    MappedFile::Change change;
+    try {
+        change = m_file.reload();
+    } catch (const std::runtime_error&) {
+        // The file could not be mapped again, it is left empty until the next change
+        change = MappedFile::Change::TRUNCATED;
+    }
+
+    switch (change) {
+        case MappedFile::Change::NONE:
+            m_search.append(m_file.data());
+            return;
+        case MappedFile::Change::GROWN:
+            // The last line can be longer now, and the mapping may have moved
+            clear_line_caches();
+            m_index.append(m_file.data());
+            m_search.append(m_file.data());
+            break;
+        case MappedFile::Change::TRUNCATED:
+        case MappedFile::Change::REPLACED:
+            clear_line_caches();
+            m_index.reset(m_file.data());
+            m_search.reset(m_file.data());
+            m_top = {};
+            m_current_match.reset();
+            m_pending_from.reset();
+            break;
+    }
+    if (at_bottom) {
+        m_scroll_to_bottom = true;
+    }
+}
+
+void Pager::set_viewport(int width, int height) {
+    m_height = std::max(height, 1);
+    if (std::max(width, 1) == m_width) return;
+    m_width = std::max(width, 1);
+    m_wraps.clear();
+    // Keep the same text at the top when the wrapping changes
+    if (m_top.line < m_index.line_count()) {
+        m_top.offset = row_start(m_top.line, m_top.offset);
+    }
+}
+
+std::string_view Pager::line_text(size_t line) const {
+    CachedLine& cached = m_lines[line % LINE_CACHE_SIZE];
+    if (cached.line != line) {
+        cached = {line, m_index.line(line)};
+    }
+    return cached.text;
+}
+
+void Pager::clear_line_caches() {
+    m_wraps.clear();
+    m_lines.fill({});
+}
+
+const Pager::LineWraps& Pager::wraps_until(size_t line, size_t offset) const {
+    LineWraps& wraps = m_wraps[line];
+    if (wraps.rows > 0) return wraps;
+    const std::string_view text = line_text(line);
+    size_t start = wraps.checkpoints.back();
+    while (start <= offset) {
+        for (size_t row = 0; row < CHECKPOINT_ROWS; row++) {
+            const size_t row_size = utf8_prefix(text.substr(start), m_width).size();
+            if (start + row_size >= text.size()) {
+                wraps.rows = (wraps.checkpoints.size() - 1) * CHECKPOINT_ROWS + row + 1;
+                return wraps;
+            }
+            start += row_size;
+        }
+        wraps.checkpoints.push_back(start);
+    }
+    return wraps;
+}
+
+size_t Pager::row_offset(size_t line, size_t row) const {
+    const std::string_view text = line_text(line);
+    if (!is_long_line(text)) return utf8_prefix(text, row * m_width).size();
+    const LineWraps& wraps = wraps_until(line, text.size());
+    size_t start = wraps.checkpoints[row / CHECKPOINT_ROWS];
+    for (size_t i = 0; i < row % CHECKPOINT_ROWS; i++) {
+        start += utf8_prefix(text.substr(start), m_width).size();
+    }
+    return start;
+}
+
+size_t Pager::row_start(size_t line, size_t offset) const {
+    const std::string_view text = line_text(line);
+    size_t start = 0;
+    if (is_long_line(text)) {
+        const auto& checkpoints = wraps_until(line, offset).checkpoints;
+        start = *std::prev(std::upper_bound(checkpoints.begin(), checkpoints.end(), offset));
+    }
+    // Walked like next_row does, so a byte inside a sequence belongs to the row of its code point
+    while (true) {
+        const size_t row_size = utf8_prefix(text.substr(start), m_width).size();
+        if (start + row_size > offset || start + row_size >= text.size()) return start;
+        start += row_size;
+    }
+}
+
+size_t Pager::row_count(size_t line) const {
+    const std::string_view text = line_text(line);
+    if (is_long_line(text)) return wraps_until(line, text.size()).rows;
+    const size_t length = utf8_length(text);
+    return length == 0 ? 1 : (length + m_width - 1) / m_width;
+}
+
+bool Pager::next_row(Position& position, size_t line_count) const {
+    if (position.line >= line_count) return false;
+    const std::string_view line = line_text(position.line);
+    const size_t row_size = utf8_prefix(line.substr(position.offset), m_width).size();
+    if (position.offset + row_size < line.size()) {
+        position.offset += row_size;
+        return true;
+    }
+    if (position.line + 1 < line_count) {
+        position.line++;
+        position.offset = 0;
+        return true;
+    }
+    return false;
+}
+
+bool Pager::previous_row(Position& position) const {
+    if (position.offset > 0) {
+        position.offset = row_start(position.line, position.offset - 1);
+        return true;
+    }
+    if (position.line > 0) {
+        position.line--;
+        position.offset = row_offset(position.line, row_count(position.line) - 1);
+        return true;
+    }
+    return false;
+}
+
+// The top position that shows the end of the file on the last row, found walking back one page from the end
+Pager::Position Pager::bottom_position() const {
+    const size_t line_count = m_index.line_count();
+    if (line_count == 0) return {};
+    Position position{line_count - 1, row_offset(line_count - 1, row_count(line_count - 1) - 1)};
+    for (int i = 1; i < m_height && previous_row(position); i++) {
+    }
+    return position;
+}
+
+void Pager::scroll_down(int rows) {
+    const size_t line_count = m_index.line_count();
+    const Position bottom = bottom_position();
+    for (int i = 0; i < rows && m_top < bottom && next_row(m_top, line_count); i++) {
+    }
+}
+
+void Pager::scroll_up(int rows) {
+    for (int i = 0; i < rows && previous_row(m_top); i++) {
+    }
+}
+
+void Pager::scroll_to_top() { m_top = {}; }
+
+void Pager::scroll_to_bottom() { m_top = bottom_position(); }
+
+uint64_t Pager::offset_of(const Position& position) const {
+    return line_text(position.line).data() - m_file.data().data() + position.offset;
+}
+
+bool Pager::jump_to(uint64_t offset) {
+    if (offset >= m_index.indexed_size()) return false;
+    const size_t line = m_index.line_of_offset(offset);
+    const uint64_t line_start = line_text(line).data() - m_file.data().data();
+    m_top = {line, row_start(line, static_cast<size_t>(offset - line_start))};
+    m_current_match = offset;
+    return true;
+}
+
+void Pager::search(std::string query) {
+    m_search.start(std::move(query));
+    m_current_match.reset();
+    m_pending_from = m_index.line_count() > 0 ? offset_of(m_top) : 0;
+}
+
+void Pager::next_match() {
+    if (m_search.get_query().empty()) return;
+    m_pending_from = m_current_match ? *m_current_match + 1 : offset_of(m_top);
+}
+
+void Pager::previous_match() {
+    if (m_search.get_query().empty()) return;
+    m_pending_from.reset();
+    const auto match = m_search.previous_match(m_current_match ? *m_current_match : offset_of(m_top));
+    if (match) {
+        jump_to(*match);
+    }
+}
+
+void Pager::handle_input(const Input& input) {
+    // Every auto-repeat of a held key scrolls again
+    const int down = input.get_key_presses(KEYS::DOWN) + input.get_key_presses('j') + input.get_scroll_delta();
+    const int up = input.get_key_presses(KEYS::UP) + input.get_key_presses('k');
+    const int pages = input.get_key_presses(KEYS::PAGE_DOWN) + input.get_key_presses(KEYS::SPACE) -
+                      input.get_key_presses(KEYS::PAGE_UP) - input.get_key_presses('b');
+    const int rows = down - up + pages * m_height;
+    if (rows > 0) {
+        scroll_down(rows);
+    } else if (rows < 0) {
+        scroll_up(-rows);
+    }
+    if (input.is_key_pressed(KEYS::HOME) || input.is_key_pressed('g')) {
+        scroll_to_top();
+    }
+    if (input.is_key_pressed(KEYS::END) || input.is_key_pressed('G')) {
+        scroll_to_bottom();
+    }
+    if (input.is_key_pressed('n')) {
+        next_match();
+    }
+    if (input.is_key_pressed('N')) {
+        previous_match();
+    }
+}
+
+size_t Pager::get_last_visible_line() const {
+    const size_t line_count = m_index.line_count();
+    Position position = m_top;
+    for (int i = 1; i < m_height && next_row(position, line_count); i++) {
+    }
+    return position.line;
+}
+
+void Pager::draw_matches(engine& engine, int x, int y, uint64_t row_start, std::string_view row) {
+    const uint64_t row_end = row_start + row.size();
+    const size_t query_size = m_search.get_query().size();
+    m_visible_matches.clear();
+    if (const auto overlapping = m_search.match_overlapping(row_start)) {
+        m_visible_matches.push_back(*overlapping);
+    }
+    m_search.matches_in(row_start, row_end, m_visible_matches);
+    for (uint64_t match : m_visible_matches) {
+        const uint64_t begin = std::max(match, row_start);
+        const uint64_t end = std::min(match + query_size, row_end);
+        const Color background = match == m_current_match ? MAGENTA : YELLOW;
+        // The rows are UTF-8, so the column is the number of code points before the match
+        const int column = utf8_length(row.substr(0, begin - row_start));
+        engine.draw_text(x + column, y, row.substr(begin - row_start, end - begin), BLACK, background);
+    }
+}
+
+void Pager::draw(engine& engine, int x, int y, Color color) {
+    reload_file();
+    if (m_scroll_to_bottom) {
+        scroll_to_bottom();
+        // A reloaded file is indexed again in the background, keep at the end until it is done
+        m_scroll_to_bottom = !m_index.is_complete();
+    }
+
+    const size_t line_count = m_index.line_count();
+    if (line_count == 0) return;
+
+    if (m_pending_from) {
+        // The search streams its results, so the jump happens on the first frame the match is known
+        const auto match = m_search.next_match(*m_pending_from);
+        if (match ? jump_to(*match) : m_search.is_complete()) {
+            m_pending_from.reset();
+        }
+    }
+
+    const bool highlight = !m_search.get_query().empty();
+    Position position = m_top;
+    for (int row = 0; row < m_height; row++) {
+        const std::string_view line = line_text(position.line);
+        if (position.offset < line.size()) {
+            const std::string_view text = utf8_prefix(line.substr(position.offset), m_width);
+            engine.draw_text(x, y + row, text, color);
+            if (highlight) {
+                draw_matches(engine, x, y + row, offset_of(position), text);
+            }
+        }
+        if (!next_row(position, line_count)) break;
+    }
+}
+
+}  // namespace TUIE
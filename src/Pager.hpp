@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Color.hpp"
+#include "FileWatcher.hpp"
+#include "Input.hpp"
+#include "LineIndex.hpp"
+#include "MappedFile.hpp"
+#include "Search.hpp"
+
+namespace TUIE {
+
+class engine;
+
+// Scrollable, line-wrapped view of a file. The file is memory mapped and indexed in the background, and wrapping is
+// only computed for the lines in the viewport, so opening and scrolling cost the same at any file size.
+class Pager {
+   public:
+    explicit Pager(const std::string& path);
+    ~Pager();
+    Pager(const Pager&) = delete;
+    Pager& operator=(const Pager&) = delete;
+
+   public:
+    // Size of the area the pager is drawn in, it defines the wrapping and the page size for scrolling
+    void set_viewport(int width, int height);
+    void scroll_down(int rows);
+    void scroll_up(int rows);
+    void scroll_to_top();
+    void scroll_to_bottom();
+    // Follows the file like tail -f: the engine wakes up on inotify events while it waits between frames, only the new
+    // bytes are indexed and searched, truncation and rotation reload the file, and while the view is at the end of the
+    // file it keeps scrolling with the new lines
+    void follow(engine& engine);
+    // Searches in the background, the view jumps to the first match after the top row as soon as it is found
+    void search(std::string query);
+    void next_match();
+    void previous_match();
+    // Default less-like keys: arrows/j/k/wheel, page up/down/space/b, home/g, end/G, n/N for the next/previous match
+    void handle_input(const Input& input);
+    void draw(engine& engine, int x, int y, Color color = WHITE);
+
+   public:
+    const std::string& get_path() const { return m_file.path(); }
+    size_t get_line_count() const { return m_index.line_count(); }
+    bool is_indexing() const { return !m_index.is_complete(); }
+    bool is_following() const { return m_watcher != nullptr; }
+    // 0-based lines shown at the top and at the bottom of the viewport
+    size_t get_first_visible_line() const { return m_top.line; }
+    size_t get_last_visible_line() const;
+    const Search& get_search() const { return m_search; }
+
+   private:
+    // A screen row: the line and the byte offset inside it where the row starts. Every code point takes a cell, so a
+    // row starts after a multiple of the width in code points.
+    struct Position {
+        size_t line = 0;
+        size_t offset = 0;
+
+        auto operator<=>(const Position& other) const = default;
+    };
+
+    // Start of every CHECKPOINT_ROWS-th row of a long line, filled only as far as the line was walked. Rows between two
+    // checkpoints are walked from the closest one, so moving around a multi-MB line costs the same as a short one.
+    struct LineWraps {
+        std::vector<size_t> checkpoints{0};
+        // Rows of the whole line, 0 until it was walked to the end
+        size_t rows = 0;
+    };
+    static constexpr size_t CHECKPOINT_ROWS = 16;
+
+    // Views of the lines used recently. LineIndex::line() finds the end of a line with memchr, which is slow for a
+    // multi-MB line and for the lines indexed after it, so every row step would pay it again.
+    struct CachedLine {
+        size_t line = SIZE_MAX;
+        std::string_view text;
+    };
+    static constexpr size_t LINE_CACHE_SIZE = 256;
+
+    std::string_view line_text(size_t line) const;
+    void clear_line_caches();
+    bool is_long_line(std::string_view line) const { return line.size() > CHECKPOINT_ROWS * m_width; }
+    // Checkpoints of the line walked until the one past offset, or until the end of the line
+    const LineWraps& wraps_until(size_t line, size_t offset) const;
+    // Byte offset of a row of the line, and of the start of the row holding a byte offset
+    size_t row_offset(size_t line, size_t row) const;
+    size_t row_start(size_t line, size_t offset) const;
+    size_t row_count(size_t line) const;
+    bool next_row(Position& position, size_t line_count) const;
+    bool previous_row(Position& position) const;
+    Position bottom_position() const;
+    uint64_t offset_of(const Position& position) const;
+    bool jump_to(uint64_t offset);
+    void reload_file();
+    void draw_matches(engine& engine, int x, int y, uint64_t row_start, std::string_view row);
+
+   private:
+    MappedFile m_file;
+    LineIndex m_index;
+    int m_width = 1;
+    int m_height = 1;
+    Position m_top;
+    // Only long lines are kept, they are dropped when the width or the file changes
+    mutable std::unordered_map<size_t, LineWraps> m_wraps;
+    mutable std::array<CachedLine, LINE_CACHE_SIZE> m_lines;
+
+    Search m_search;
+    std::optional<uint64_t> m_current_match;
+    // Match waiting for the search or the index to reach it before jumping
+    std::optional<uint64_t> m_pending_from;
+    std::vector<uint64_t> m_visible_matches;
+
+    std::unique_ptr<FileWatcher> m_watcher;
+    engine* m_engine = nullptr;
+    // The file changed but it is only reloaded once the index is not reading the old mapping anymore
+    bool m_file_changed = false;
+    bool m_scroll_to_bottom = false;
+};
+
+}  // namespace TUIE
@@ -0,0 +1,86 @@
+#include "Palette.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace TUIE {
+
+namespace {
+
+// Levels of the 6x6x6 color cube of the 256 color palette
+constexpr std::array<int, 6> CUBE_LEVELS = {0, 95, 135, 175, 215, 255};
+
+constexpr std::array<Color, 16> COLORS_16_PALETTE = {{
+    {0, 0, 0},
+    {205, 0, 0},
+    {0, 205, 0},
+    {205, 205, 0},
+    {0, 0, 238},
+    {205, 0, 205},
+    {0, 205, 205},
+    {229, 229, 229},
+    {127, 127, 127},
+    {255, 0, 0},
+    {0, 255, 0},
+    {255, 255, 0},
+    {92, 92, 255},
+    {255, 0, 255},
+    {0, 255, 255},
+    {255, 255, 255},
+}};
+
+int distance(int r, int g, int b, Color color) {
+    const int dr = r - color.r;
+    const int dg = g - color.g;
+    const int db = b - color.b;
+    return dr * dr + dg * dg + db * db;
+}
+
+int nearest_cube_level(int value) {
+    // The first step is wider than the others
+    if (value < 48) return 0;
+    if (value < 115) return 1;
+    return std::min((value - 35) / 40, 5);
+}
+
+}  // namespace
+
+int palette_index(int r, int g, int b, Palette palette) {
+    r = std::clamp(r, 0, 255);
+    g = std::clamp(g, 0, 255);
+    b = std::clamp(b, 0, 255);
+    if (palette == Palette::COLORS_16) {
+        const auto nearest = std::ranges::min_element(
+            COLORS_16_PALETTE, [&](Color a, Color c) { return distance(r, g, b, a) < distance(r, g, b, c); });
+        return nearest - COLORS_16_PALETTE.begin();
+    }
+    const int cube_r = nearest_cube_level(r);
+    const int cube_g = nearest_cube_level(g);
+    const int cube_b = nearest_cube_level(b);
+    const int cube_index = 16 + cube_r * 36 + cube_g * 6 + cube_b;
+    const int gray_index = 232 + std::clamp(((r + g + b) / 3 - 3) / 10, 0, 23);
+    return distance(r, g, b, palette_color(gray_index)) < distance(r, g, b, palette_color(cube_index)) ? gray_index
+                                                                                                        : cube_index;
+}
+
+Color palette_color(int index) {
+    if (index < 16) return COLORS_16_PALETTE[std::max(index, 0)];
+    if (index < 232) {
+        index -= 16;
+        return {static_cast<uint8_t>(CUBE_LEVELS[index / 36]), static_cast<uint8_t>(CUBE_LEVELS[index / 6 % 6]),
+                static_cast<uint8_t>(CUBE_LEVELS[index % 6])};
+    }
+    const uint8_t gray_level = 8 + (std::min(index, 255) - 232) * 10;
+    return {gray_level, gray_level, gray_level};
+}
+
+Color nearest_color(int r, int g, int b, Palette palette) {
+    if (palette == Palette::TRUE_COLOR) {
+        return {static_cast<uint8_t>(std::clamp(r, 0, 255)), static_cast<uint8_t>(std::clamp(g, 0, 255)),
+                static_cast<uint8_t>(std::clamp(b, 0, 255))};
+    }
+    return palette_color(palette_index(r, g, b, palette));
+}
+
+}  // namespace TUIE
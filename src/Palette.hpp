@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Color.hpp"
+
+namespace TUIE {
+
+// Colors a terminal (or an image) is reduced to, the 256 and 16 color palettes are the xterm defaults
+enum class Palette { TRUE_COLOR, COLORS_256, COLORS_16 };
+
+// Index of the nearest palette color in the xterm numbering. The 256 color palette only uses the color cube and the
+// gray ramp, the 16 system colors are left out as terminals change them.
+int palette_index(int r, int g, int b, Palette palette);
+// Default RGB of an xterm palette index
+Color palette_color(int index);
+// The color itself for TRUE_COLOR, the values are clamped to 0-255
+Color nearest_color(int r, int g, int b, Palette palette);
+
+}  // namespace TUIE
@@ -0,0 +1,238 @@
+#include "Recorder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Renderer.hpp"
+
+namespace TUIE {
+
+namespace {
+
+enum DeltaOp : uint64_t {
+    OP_END = 0,
+    OP_SKIP = 1,
+    OP_LITERAL = 2,
+    OP_REPEAT = 3,
+};
+
+constexpr std::string_view MAGIC = "TUIR";
+
+void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void put_u64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out += static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+void put_op(std::string& out, DeltaOp op, uint64_t count) { put_varint(out, count << 2 | op); }
+
+void put_color(std::string& out, Color color) {
+    out += static_cast<char>(color.r);
+    out += static_cast<char>(color.g);
+    out += static_cast<char>(color.b);
+    out += static_cast<char>(color.without_color);
+}
+
+void put_cell(std::string& out, const TerminalCell& cell) {
+    put_varint(out, cell.character);
+    put_color(out, cell.foreground_color);
+    put_color(out, cell.background_color);
+}
+
+void put_literal(std::string& out, std::span<const TerminalCell> cells, size_t begin, size_t end) {
+    put_op(out, OP_LITERAL, end - begin);
+    for (size_t i = begin; i < end; i++) {
+        put_cell(out, cells[i]);
+    }
+}
+
+// Encodes a run of changed cells, collapsing repeated cells (typical of backgrounds and rects) into one op
+void put_changed(std::string& out, std::span<const TerminalCell> cells, size_t begin, size_t end) {
+    size_t literal_start = begin;
+    size_t i = begin;
+    while (i < end) {
+        size_t j = i + 1;
+        while (j < end && cells[j] == cells[i]) j++;
+        if (j - i >= 3) {
+            if (i > literal_start) put_literal(out, cells, literal_start, i);
+            put_op(out, OP_REPEAT, j - i);
+            put_cell(out, cells[i]);
+            literal_start = j;
+        }
+        i = j;
+    }
+    if (end > literal_start) put_literal(out, cells, literal_start, end);
+}
+
+void put_delta(std::string& out, std::span<const TerminalCell> base, std::span<const TerminalCell> cells) {
+    size_t i = 0;
+    while (i < cells.size()) {
+        size_t start = i;
+        while (i < cells.size() && cells[i] == base[i]) i++;
+        if (i > start) put_op(out, OP_SKIP, i - start);
+        if (i == cells.size()) break;
+
+        start = i;
+        while (i < cells.size() && cells[i] != base[i]) i++;
+        put_changed(out, cells, start, i);
+    }
+    put_varint(out, OP_END);
+}
+
+}  // namespace
+
+Recorder::Recorder(const std::string& path, Palette palette)
+    : m_file(path, std::ios::out | std::ios::binary | std::ios::trunc),
+      m_palette(palette),
+      m_last_time(std::chrono::steady_clock::now()) {
+    if (!m_file.is_open()) {
+        throw std::runtime_error("Could not open recording file: " + path);
+    }
+    m_frame.append(MAGIC);
+    put_varint(m_frame, VERSION);
+    put_varint(m_frame, static_cast<uint64_t>(palette));
+    m_file.write(m_frame.data(), m_frame.size());
+}
+
+void Recorder::record_frame(const TerminalBuffer& buffer) {
+    const auto now = std::chrono::steady_clock::now();
+    const auto delta_time = std::chrono::duration_cast<std::chrono::microseconds>(now - m_last_time).count();
+    m_last_time = now;
+    if (m_last_buffer.cells().empty()) {
+        // Like the engine, the first frame is drawn on top of a blank screen
+        m_last_buffer.resize(buffer.get_width(), buffer.get_height());
+    }
+
+    // The digest is taken from the headless renderer so a replay can reproduce it exactly
+    DigestStream digest_stream;
+    Renderer(digest_stream, m_palette).draw(m_last_buffer, buffer);
+    const FrameDigest digest = digest_stream.digest();
+
+    m_frame.clear();
+    put_varint(m_frame, delta_time);
+    put_varint(m_frame, m_input.size());
+    m_frame.append(m_input);
+    put_varint(m_frame, buffer.get_width());
+    put_varint(m_frame, buffer.get_height());
+    put_varint(m_frame, digest.bytes);
+    put_u64(m_frame, digest.hash);
+
+    if (m_last_buffer.get_width() != buffer.get_width() || m_last_buffer.get_height() != buffer.get_height()) {
+        m_last_buffer.resize(buffer.get_width(), buffer.get_height());
+    }
+    put_delta(m_frame, m_last_buffer.cells(), buffer.cells());
+    m_file.write(m_frame.data(), m_frame.size());
+
+    m_last_buffer = buffer;
+    m_input.clear();
+}
+
+RecordingReader::RecordingReader(const std::string& path) : m_file(path, std::ios::in | std::ios::binary) {
+    if (!m_file.is_open()) {
+        throw std::runtime_error("Could not open recording file: " + path);
+    }
+    char magic[MAGIC.size()];
+    if (!m_file.read(magic, sizeof(magic)) || std::string_view(magic, sizeof(magic)) != MAGIC) {
+        throw std::runtime_error("Not a recording file: " + path);
+    }
+    if (read_varint() != Recorder::VERSION) {
+        throw std::runtime_error("Unsupported recording version: " + path);
+    }
+    const uint64_t palette = read_varint();
+    if (palette > static_cast<uint64_t>(Palette::COLORS_16)) {
+        throw std::runtime_error("Unsupported recording palette: " + path);
+    }
+    m_palette = static_cast<Palette>(palette);
+}
+
+uint64_t RecordingReader::read_varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const int byte = m_file.get();
+        if (byte == std::ifstream::traits_type::eof()) {
+            throw std::runtime_error("Truncated recording");
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    throw std::runtime_error("Malformed varint in recording");
+}
+
+TerminalCell RecordingReader::read_cell() {
+    TerminalCell cell;
+    cell.character = static_cast<char32_t>(read_varint());
+    unsigned char colors[8];
+    if (!m_file.read(reinterpret_cast<char*>(colors), sizeof(colors))) {
+        throw std::runtime_error("Truncated recording");
+    }
+    cell.foreground_color = {colors[0], colors[1], colors[2], colors[3] != 0};
+    cell.background_color = {colors[4], colors[5], colors[6], colors[7] != 0};
+    return cell;
+}
+
+bool RecordingReader::next_frame(RecordedFrame& frame) {
+    if (m_file.peek() == std::ifstream::traits_type::eof()) {
+        return false;
+    }
+    frame.delta_time_us = read_varint();
+    frame.input.resize(read_varint());
+    if (!m_file.read(frame.input.data(), frame.input.size())) {
+        throw std::runtime_error("Truncated recording");
+    }
+    const int width = static_cast<int>(read_varint());
+    const int height = static_cast<int>(read_varint());
+    frame.digest.bytes = read_varint();
+    unsigned char hash[8];
+    if (!m_file.read(reinterpret_cast<char*>(hash), sizeof(hash))) {
+        throw std::runtime_error("Truncated recording");
+    }
+    frame.digest.hash = 0;
+    for (int i = 0; i < 8; i++) {
+        frame.digest.hash |= static_cast<uint64_t>(hash[i]) << (i * 8);
+    }
+
+    std::swap(frame.previous_buffer, frame.buffer);
+    if (frame.previous_buffer.cells().empty()) {
+        // Like the recorder, the first frame is drawn on top of a blank screen
+        frame.previous_buffer.resize(width, height);
+    }
+    frame.buffer = frame.previous_buffer;
+    if (frame.buffer.get_width() != width || frame.buffer.get_height() != height) {
+        frame.buffer.resize(width, height);
+    }
+
+    std::span<TerminalCell> cells = frame.buffer.cells();
+    size_t position = 0;
+    while (true) {
+        const uint64_t op = read_varint();
+        const uint64_t count = op >> 2;
+        if ((op & 3) == OP_END) break;
+        if (position + count > cells.size()) {
+            throw std::runtime_error("Recording frame out of bounds");
+        }
+        switch (op & 3) {
+            case OP_SKIP:
+                break;
+            case OP_LITERAL:
+                for (uint64_t i = 0; i < count; i++) {
+                    cells[position + i] = read_cell();
+                }
+                break;
+            case OP_REPEAT:
+                std::fill_n(cells.begin() + position, count, read_cell());
+                break;
+        }
+        position += count;
+    }
+    return true;
+}
+
+}  // namespace TUIE
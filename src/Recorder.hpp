@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "Palette.hpp"
+#include "TerminalBuffer.hpp"
+
+namespace TUIE {
+
+// Size and FNV-1a hash of the bytes the renderer produced for one frame
+struct FrameDigest {
+    uint64_t bytes = 0;
+    uint64_t hash = 14695981039346656037ull;
+
+    bool operator==(const FrameDigest& other) const { return bytes == other.bytes && hash == other.hash; }
+    bool operator!=(const FrameDigest& other) const { return !(*this == other); }
+};
+
+// Stream buffer that discards the output and only keeps its digest
+struct DigestBuffer : std::streambuf {
+    char m_buffer[4096];
+    FrameDigest m_digest;
+
+    DigestBuffer() { setp(m_buffer, m_buffer + sizeof(m_buffer)); }
+
+    int_type overflow(int_type c) override {
+        consume();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            sputc(traits_type::to_char_type(c));
+        }
+        return c;
+    }
+
+    int sync() override {
+        consume();
+        return 0;
+    }
+
+    void consume() {
+        for (char* it = pbase(); it != pptr(); it++) {
+            m_digest.hash = (m_digest.hash ^ static_cast<unsigned char>(*it)) * 1099511628211ull;
+        }
+        m_digest.bytes += pptr() - pbase();
+        setp(pbase(), epptr());
+    }
+};
+
+struct DigestStream : private DigestBuffer, public std::ostream {
+    DigestStream() : std::ostream(static_cast<DigestBuffer*>(this)) {}
+
+    FrameDigest digest() {
+        flush();
+        return m_digest;
+    }
+};
+
+// Records a session to a compact file: every frame is stored as a delta against the previous one (run-length and
+// varint encoded) with its timestamp, the raw input bytes read during the frame and the digest of the renderer output.
+//
+// File layout: "TUIR" varint(version) varint(palette), then for every frame:
+//   varint(us since previous frame) varint(input size) input bytes varint(width) varint(height)
+//   varint(output bytes) u64le(output hash) ops... varint(0)
+// where each op is varint(count << 2 | kind), kind 1 = skip cells, 2 = literal cells, 3 = repeat one cell. A cell is
+// varint(code point) and the r, g, b, without_color bytes of its foreground and background (version 1 stored a byte).
+class Recorder {
+   public:
+    static constexpr uint64_t VERSION = 2;
+
+    // The digests are taken with the palette the engine renders with, so they match what the terminal was sent
+    Recorder(const std::string& path, Palette palette);
+
+   public:
+    void record_input(std::string_view bytes) { m_input.append(bytes); }
+    void record_frame(const TerminalBuffer& buffer);
+
+   private:
+    std::ofstream m_file;
+    Palette m_palette;
+    std::string m_input;
+    std::string m_frame;
+    TerminalBuffer m_last_buffer{0, 0};
+    std::chrono::steady_clock::time_point m_last_time;
+};
+
+struct RecordedFrame {
+    uint64_t delta_time_us = 0;
+    std::string input;
+    FrameDigest digest;
+    // The buffer the frame was rendered against and the decoded frame itself
+    TerminalBuffer previous_buffer{0, 0};
+    TerminalBuffer buffer{0, 0};
+};
+
+class RecordingReader {
+   public:
+    explicit RecordingReader(const std::string& path);
+
+   public:
+    // Decodes the next frame on top of the previous one, returns false at the end of the recording
+    bool next_frame(RecordedFrame& frame);
+    // The palette the digests were taken with
+    Palette get_palette() const { return m_palette; }
+
+   private:
+    uint64_t read_varint();
+    TerminalCell read_cell();
+
+   private:
+    std::ifstream m_file;
+    Palette m_palette;
+};
+
+}  // namespace TUIE
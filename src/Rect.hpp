@@ -0,0 +1,15 @@
+#pragma once
+
+namespace TUIE {
+
+struct Rect {
+    int x;
+    int y;
+    int width;
+    int height;
+
+    bool operator==(const Rect& other) const = default;
+    bool empty() const { return width <= 0 || height <= 0; }
+};
+
+}  // namespace TUIE
@@ -0,0 +1,28 @@
+#include "RenderTarget.hpp"
+
+#include <algorithm>
+
+#include "TUIengine.hpp"
+
+namespace TUIE {
+
+void RenderTarget::draw(engine& engine, int x, int y, int width, int height, uint64_t version,
+                        const std::function<void()>& render) {
+    if (!m_valid || m_version != version || m_buffer.get_width() != width || m_buffer.get_height() != height) {
+        if (m_buffer.get_width() != width || m_buffer.get_height() != height) {
+            m_buffer = TerminalBuffer(width, height);
+        } else {
+            std::ranges::fill(m_buffer.cells(), TerminalCell{});
+        }
+        // Keep the previous target so render targets can be nested
+        TerminalBuffer* previous_target = engine.get_render_target();
+        engine.set_render_target(&m_buffer);
+        render();
+        engine.set_render_target(previous_target);
+        m_version = version;
+        m_valid = true;
+    }
+    engine.blit(m_buffer, {0, 0, width, height}, x, y);
+}
+
+}  // namespace TUIE
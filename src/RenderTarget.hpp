@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "TerminalBuffer.hpp"
+
+namespace TUIE {
+
+class engine;
+
+// Off-screen copy of a region that rarely changes (help screens, legends, frames). The region is rendered into its own
+// buffer only when the version key or the size changes, every other frame it is copied to the screen row by row.
+class RenderTarget {
+   public:
+    RenderTarget() = default;
+
+   public:
+    // The draw calls made by render land in the off-screen buffer, relative to its top left corner
+    void draw(engine& engine, int x, int y, int width, int height, uint64_t version,
+              const std::function<void()>& render);
+    void invalidate() { m_valid = false; }
+    bool is_valid() const { return m_valid; }
+    const TerminalBuffer& get_buffer() const { return m_buffer; }
+
+   private:
+    TerminalBuffer m_buffer{0, 0};
+    uint64_t m_version = 0;
+    bool m_valid = false;
+};
+
+}  // namespace TUIE
@@ -0,0 +1,93 @@
+#include "Renderer.hpp"
+
+#include "Utf8.hpp"
+#include "debug.hpp"
+
+namespace TUIE {
+
+void Renderer::draw(const TerminalBuffer& previous_buffer, const TerminalBuffer& current_buffer) {
+    // This function compare the current buffer with the previous buffer and only prints the changes
+    bool first_bg = false, first_fg = false;
+    Color last_bg = {0, 0, 0};
+    Color last_fg = {0, 0, 0};
+    bool cursor_moved = true;
+
+    // The whole buffers do not fit in a log message, print them with operator<< of TerminalBuffer when needed
+    log_msg(LogCategory::RENDER, LogLevel::VERBOSE,
+            "Drawing buffer " << current_buffer.get_width() << "x" << current_buffer.get_height() << " over "
+                              << previous_buffer.get_width() << "x" << previous_buffer.get_height());
+    reset_cursor();
+    reset_colors();
+    for (int y = 0; y < current_buffer.get_height(); y++) {
+        for (int x = 0; x < current_buffer.get_width(); x++) {
+            const TerminalCell current_cell = current_buffer.get_cell(x, y);
+            bool cells_equal = false;
+            if (previous_buffer.is_inside(x, y)) {
+                cells_equal = current_cell == previous_buffer.get_cell(x, y);
+            }
+
+            if (!cells_equal) {
+                if (cursor_moved) {
+                    set_cursor_position(x + 1, y + 1);
+                    cursor_moved = false;
+                    log_msg(LogCategory::RENDER, LogLevel::VERBOSE, "Cursor moved to " << x << ", " << y + 1);
+                }
+                if (current_cell.background_color != last_bg || !first_bg) {
+                    set_background_color(current_cell.background_color);
+                    last_bg = current_cell.background_color;
+                    first_bg = true;
+                    log_msg(LogCategory::RENDER, LogLevel::VERBOSE, "Background color changed to " << current_cell.background_color);
+                }
+                if (current_cell.foreground_color != last_fg || !first_fg) {
+                    set_foreground_color(current_cell.foreground_color);
+                    last_fg = current_cell.foreground_color;
+                    first_fg = true;
+                    log_msg(LogCategory::RENDER, LogLevel::VERBOSE, "Foreground color changed to " << current_cell.foreground_color);
+                }
+                write_utf8(m_out, current_cell.character);
+                log_msg(LogCategory::RENDER, LogLevel::VERBOSE,
+                        "Character printed " << static_cast<uint32_t>(current_cell.character) << " at " << x << ", "
+                                             << y);
+            } else {
+                cursor_moved = true;
+            }
+        }
+        cursor_moved = true;
+    }
+}
+
+void Renderer::reset_cursor() { m_out << "\033[H"; }
+void Renderer::reset_colors() { m_out << "\033[0m"; }
+void Renderer::reset_foreground() { m_out << "\033[39m"; }
+void Renderer::reset_background() { m_out << "\033[49m"; }
+void Renderer::set_cursor_position(int x, int y) { m_out << "\033[" << y << ";" << x << "H"; }
+void Renderer::set_background_color(Color color) {
+    if (color.without_color) {
+        reset_background();
+    } else {
+        set_color(color, true);
+    }
+}
+void Renderer::set_foreground_color(Color color) {
+    if (color.without_color) {
+        reset_foreground();
+    } else {
+        set_color(color, false);
+    }
+}
+void Renderer::set_color(Color color, bool background) {
+    if (m_palette == Palette::TRUE_COLOR) {
+        m_out << (background ? "\033[48;2;" : "\033[38;2;") << (int)color.r << ";" << (int)color.g << ";" << (int)color.b
+              << "m";
+        return;
+    }
+    const int index = palette_index(color.r, color.g, color.b, m_palette);
+    if (m_palette == Palette::COLORS_256) {
+        m_out << (background ? "\033[48;5;" : "\033[38;5;") << index << "m";
+    } else {
+        // The 16 colors use the basic SGR codes, the bright half (8-15) has its own range
+        m_out << "\033[" << (index < 8 ? (background ? 40 : 30) + index : (background ? 100 : 90) + index - 8) << "m";
+    }
+}
+
+}  // namespace TUIE
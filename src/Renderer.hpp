@@ -0,0 +1,36 @@
+#pragma once
+
+#include <ostream>
+
+#include "Color.hpp"
+#include "Palette.hpp"
+#include "TerminalBuffer.hpp"
+
+namespace TUIE {
+
+// Translates the difference between two buffers into the escape sequences that update the terminal. It only writes
+// to a stream, so the same code path is used for the real terminal and for headless rendering (recording/replay).
+class Renderer {
+   public:
+    // The colors are reduced to the palette of the terminal, the headless renderers keep the default true color
+    explicit Renderer(std::ostream& out, Palette palette = Palette::TRUE_COLOR) : m_out(out), m_palette(palette) {}
+
+   public:
+    void draw(const TerminalBuffer& previous_buffer, const TerminalBuffer& current_buffer);
+
+   private:
+    void reset_cursor();
+    void reset_colors();
+    void reset_foreground();
+    void reset_background();
+    void set_cursor_position(int x, int y);
+    void set_background_color(Color color);
+    void set_foreground_color(Color color);
+    void set_color(Color color, bool background);
+
+   private:
+    std::ostream& m_out;
+    Palette m_palette;
+};
+
+}  // namespace TUIE
@@ -0,0 +1,147 @@
+#include "Scheduler.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <stdexcept>
+
+#include "Trace.hpp"
+
+namespace TUIE {
+
+namespace {
+
+thread_local Scheduler* t_current = nullptr;
+
+// Makes the scheduler current while it resumes tasks, nested schedulers restore the previous one
+struct CurrentScheduler {
+    Scheduler* previous;
+    explicit CurrentScheduler(Scheduler* scheduler) : previous(std::exchange(t_current, scheduler)) {}
+    ~CurrentScheduler() { t_current = previous; }
+};
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+thread_local FreeFrame* t_free_frames[FramePool::MAX_SIZE / FramePool::GRANULE] = {};
+
+size_t size_class(size_t size) { return (size + FramePool::GRANULE - 1) / FramePool::GRANULE - 1; }
+
+}  // namespace
+
+void* FramePool::allocate(size_t size) {
+    if (size > MAX_SIZE) return ::operator new(size);
+    FreeFrame*& free_list = t_free_frames[size_class(size)];
+    if (FreeFrame* frame = free_list) {
+        free_list = frame->next;
+        return frame;
+    }
+    return ::operator new((size_class(size) + 1) * GRANULE);
+}
+
+void FramePool::deallocate(void* pointer, size_t size) {
+    if (size > MAX_SIZE) {
+        ::operator delete(pointer);
+        return;
+    }
+    FreeFrame* frame = static_cast<FreeFrame*>(pointer);
+    FreeFrame*& free_list = t_free_frames[size_class(size)];
+    frame->next = free_list;
+    free_list = frame;
+}
+
+std::coroutine_handle<> Task::promise_type::FinalAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> handle) noexcept {
+    if (std::coroutine_handle<> continuation = handle.promise().continuation) {
+        return continuation;
+    }
+    // A spawned task, the scheduler destroys it once it is back in control
+    Scheduler::current().m_finished.push_back(handle);
+    return std::noop_coroutine();
+}
+
+Scheduler::~Scheduler() {
+    // Destroying a suspended task also destroys the tasks it is awaiting
+    for (void* address : m_tasks) {
+        std::coroutine_handle<>::from_address(address).destroy();
+    }
+}
+
+Scheduler& Scheduler::current() {
+    if (!t_current) {
+        throw std::logic_error("Awaiting outside of a task of the engine scheduler");
+    }
+    return *t_current;
+}
+
+void Scheduler::spawn(Task task) {
+    Task::handle_type handle = task.release();
+    m_tasks.insert(handle.address());
+    m_next_frame.push_back(handle);
+}
+
+void Scheduler::run_frame(const std::vector<InputEvent>& events) {
+    TRACE_SCOPE("Scheduler::run_frame");
+    CurrentScheduler current(this);
+
+    const auto now = std::chrono::steady_clock::now();
+    while (!m_sleepers.empty() && m_sleepers.front().when <= now) {
+        const std::coroutine_handle<> handle = m_sleepers.front().handle;
+        std::ranges::pop_heap(m_sleepers, std::greater<>());
+        m_sleepers.pop_back();
+        handle.resume();
+    }
+
+    // Every keyboard event goes to the tasks waiting at that point, a task that waits again gets the next one
+    for (const InputEvent& event : events) {
+        if (event.type != InputEvent::type_t::Keyboard || m_key_waiters.empty()) continue;
+        if (event.as.keyboardEvent.action == KEY_ACTION::RELEASED) continue;
+        m_key_resuming.swap(m_key_waiters);
+        for (const KeyWaiter& waiter : m_key_resuming) {
+            *waiter.event = event.as.keyboardEvent;
+            waiter.handle.resume();
+        }
+        m_key_resuming.clear();
+    }
+
+    m_resuming.swap(m_next_frame);
+    for (std::coroutine_handle<> handle : m_resuming) {
+        handle.resume();
+    }
+    m_resuming.clear();
+
+    destroy_finished();
+}
+
+void Scheduler::destroy_finished() {
+    std::exception_ptr exception;
+    for (Task::handle_type handle : m_finished) {
+        if (!exception) {
+            exception = handle.promise().exception;
+        }
+        m_tasks.erase(handle.address());
+        handle.destroy();
+    }
+    m_finished.clear();
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void FrameAwaiter::await_suspend(std::coroutine_handle<> handle) const {
+    Scheduler::current().m_next_frame.push_back(handle);
+}
+
+void KeyAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    Scheduler::current().m_key_waiters.push_back({handle, &event});
+}
+
+void SleepAwaiter::await_suspend(std::coroutine_handle<> handle) const {
+    Scheduler& scheduler = Scheduler::current();
+    scheduler.m_sleepers.push_back({when, handle});
+    std::ranges::push_heap(scheduler.m_sleepers, std::greater<>());
+}
+
+SleepAwaiter sleep(std::chrono::milliseconds duration) { return {std::chrono::steady_clock::now() + duration}; }
+
+}  // namespace TUIE
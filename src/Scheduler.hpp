@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+#include "Input.hpp"
+#include "Task.hpp"
+
+namespace TUIE {
+
+// Resumes the tasks of an engine once per frame, after the input of the frame is read. Waiting tasks are only kept in
+// the list of what they wait for, so the cost of a frame depends on the tasks that resume, not on the tasks alive.
+class Scheduler {
+   public:
+    Scheduler() = default;
+    ~Scheduler();
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+   public:
+    void spawn(Task task);
+    // Resumes the expired sleeps, the key waiters once per keyboard event and then the frame waiters
+    void run_frame(const std::vector<InputEvent>& events);
+    size_t get_task_count() const { return m_tasks.size(); }
+
+    // The scheduler running tasks on this thread, the awaitables register with it
+    static Scheduler& current();
+
+   private:
+    friend struct FrameAwaiter;
+    friend struct KeyAwaiter;
+    friend struct SleepAwaiter;
+    friend struct Task::promise_type::FinalAwaiter;
+
+    struct KeyWaiter {
+        std::coroutine_handle<> handle;
+        KeyboardEvent* event;
+    };
+    struct Sleeper {
+        std::chrono::steady_clock::time_point when;
+        std::coroutine_handle<> handle;
+        bool operator>(const Sleeper& other) const { return when > other.when; }
+    };
+
+    void destroy_finished();
+
+   private:
+    std::unordered_set<void*> m_tasks;
+    std::vector<std::coroutine_handle<>> m_next_frame;
+    std::vector<std::coroutine_handle<>> m_resuming;
+    std::vector<KeyWaiter> m_key_waiters;
+    std::vector<KeyWaiter> m_key_resuming;
+    std::vector<Sleeper> m_sleepers;
+    std::vector<Task::handle_type> m_finished;
+};
+
+struct FrameAwaiter {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) const;
+    void await_resume() const noexcept {}
+};
+
+// Resumes with the next key press (or repeat), releases are only in the input state
+struct KeyAwaiter {
+    KeyboardEvent event;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    KeyboardEvent await_resume() const noexcept { return event; }
+};
+
+// Resumes on the first frame after the time has passed
+struct SleepAwaiter {
+    std::chrono::steady_clock::time_point when;
+
+    bool await_ready() const noexcept { return when <= std::chrono::steady_clock::now(); }
+    void await_suspend(std::coroutine_handle<> handle) const;
+    void await_resume() const noexcept {}
+};
+
+SleepAwaiter sleep(std::chrono::milliseconds duration);
+
+}  // namespace TUIE
@@ -0,0 +1,160 @@
+#include "ScrollView.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace TUIE {
+
+void ScrollView::set_viewport(int x, int y, int width, int height) {
+    m_x = x;
+    m_y = y;
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    sync();
+}
+
+int ScrollView::row_height(size_t index) const {
+    return m_provider.row_height ? std::max(m_provider.row_height(index), 1) : 1;
+}
+
+void ScrollView::add_height(size_t index, int64_t delta) {
+    for (size_t i = index + 1; i < m_tree.size(); i += i & (~i + 1)) {
+        m_tree[i] += delta;
+    }
+}
+
+void ScrollView::append_row(size_t index) {
+    // The new node covers the rows (i - lowbit(i), i], which are all known already
+    const size_t i = index + 1;
+    const size_t lowbit = i & (~i + 1);
+    m_tree.push_back(row_height(index) + offset_of(index) - offset_of(i - lowbit));
+}
+
+// Total height of the rows before index
+int64_t ScrollView::offset_of(size_t index) const {
+    if (!m_provider.row_height) return index;
+    int64_t sum = 0;
+    for (size_t i = index; i > 0; i -= i & (~i + 1)) {
+        sum += m_tree[i];
+    }
+    return sum;
+}
+
+// Row that contains the cell at offset (the count if it is past the end)
+size_t ScrollView::index_at(int64_t offset) const {
+    if (!m_provider.row_height) return std::min<size_t>(std::max<int64_t>(offset, 0), m_count);
+    size_t position = 0;
+    for (size_t step = std::bit_floor(m_tree.size()); step > 0; step >>= 1) {
+        if (position + step < m_tree.size() && m_tree[position + step] <= offset) {
+            position += step;
+            offset -= m_tree[position];
+        }
+    }
+    return position;
+}
+
+void ScrollView::sync() {
+    const size_t count = m_provider.count();
+    if (m_provider.row_height) {
+        if (m_tree.empty()) {
+            // First build in O(n): every node adds itself to its parent
+            m_tree.assign(count + 1, 0);
+            for (size_t i = 1; i <= count; i++) {
+                m_tree[i] += row_height(i - 1);
+                const size_t parent = i + (i & (~i + 1));
+                if (parent <= count) m_tree[parent] += m_tree[i];
+            }
+            m_count = count;
+        }
+        // Rows removed at the end do not change the prefix sums of the others
+        if (count < m_count) m_tree.resize(count + 1);
+        for (size_t index = m_count; index < count; index++) {
+            append_row(index);
+        }
+    }
+    m_count = count;
+    m_top = std::min(m_top, top_for_end(offset_of(m_count)));
+}
+
+void ScrollView::invalidate_row(size_t index) {
+    if (!m_provider.row_height || index >= m_count) return;
+    add_height(index, row_height(index) - (offset_of(index + 1) - offset_of(index)));
+}
+
+void ScrollView::invalidate_heights() {
+    m_tree.clear();
+    m_count = 0;
+    sync();
+}
+
+// First top row that shows everything up to end_offset, i.e. puts end_offset at the bottom of the viewport
+size_t ScrollView::top_for_end(int64_t end_offset) const {
+    if (end_offset <= m_height) return 0;
+    const size_t index = index_at(end_offset - m_height);
+    return offset_of(index) < end_offset - m_height ? index + 1 : index;
+}
+
+void ScrollView::scroll_by(int64_t rows) {
+    const int64_t top = static_cast<int64_t>(m_top) + rows;
+    m_top = std::clamp<int64_t>(top, 0, top_for_end(offset_of(m_count)));
+}
+
+void ScrollView::page_down() { scroll_to(index_at(offset_of(m_top) + m_height)); }
+
+void ScrollView::page_up() { scroll_to(index_at(std::max<int64_t>(offset_of(m_top) - m_height, 0))); }
+
+void ScrollView::scroll_to(size_t index) { m_top = std::min(index, top_for_end(offset_of(m_count))); }
+
+void ScrollView::scroll_to_bottom() { scroll_to(m_count); }
+
+void ScrollView::ensure_visible(size_t index) {
+    if (index < m_top) {
+        scroll_to(index);
+    } else if (index < m_count) {
+        m_top = std::max(m_top, top_for_end(offset_of(index + 1)));
+    }
+}
+
+void ScrollView::handle_input(const Input& input) {
+    // Every auto-repeat of a held key scrolls again
+    const int rows = input.get_key_presses(KEYS::DOWN) - input.get_key_presses(KEYS::UP) + input.get_scroll_delta();
+    if (rows != 0) {
+        scroll_by(rows);
+    }
+    for (int i = input.get_key_presses(KEYS::PAGE_DOWN) + input.get_key_presses(KEYS::SPACE); i > 0; i--) {
+        page_down();
+    }
+    for (int i = input.get_key_presses(KEYS::PAGE_UP); i > 0; i--) {
+        page_up();
+    }
+    if (input.is_key_pressed(KEYS::HOME)) {
+        scroll_to_top();
+    }
+    if (input.is_key_pressed(KEYS::END)) {
+        scroll_to_bottom();
+    }
+}
+
+void ScrollView::draw() {
+    int y = 0;
+    for (size_t index = m_top; index < m_count && y < m_height; index++) {
+        // The last row can be cut by the bottom of the viewport
+        const int height = std::min(row_height(index), m_height - y);
+        m_provider.render_row(index, RowSpan{m_x, m_y + y, m_width, height});
+        y += height;
+    }
+}
+
+size_t ScrollView::get_last_visible() const {
+    if (m_count == 0) return 0;
+    return std::min(index_at(offset_of(m_top) + m_height - 1), m_count - 1);
+}
+
+std::optional<size_t> ScrollView::row_at(int y) const {
+    if (y < m_y || y >= m_y + m_height) return std::nullopt;
+    const size_t index = index_at(offset_of(m_top) + (y - m_y));
+    if (index >= m_count) return std::nullopt;
+    return index;
+}
+
+}  // namespace TUIE
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "Input.hpp"
+
+namespace TUIE {
+
+// Area of the screen where a row has to be rendered
+struct RowSpan {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// Source of the rows of a ScrollView, the view only asks for the rows it shows
+struct RowProvider {
+    std::function<size_t()> count;
+    std::function<void(size_t index, RowSpan span)> render_row;
+    // Optional, every row is one cell high when not set
+    std::function<int(size_t index)> row_height = nullptr;
+};
+
+// Virtualized list: only the rows inside the viewport are rendered. Variable row heights are kept in a prefix-sum
+// (Fenwick) index, so jumping by pages, to the end or to a screen position is O(log n) for millions of rows, and new
+// rows appended to the provider are added in O(log n) each.
+class ScrollView {
+   public:
+    explicit ScrollView(RowProvider provider) : m_provider(std::move(provider)) {}
+
+   public:
+    void set_viewport(int x, int y, int width, int height);
+    void scroll_by(int64_t rows);
+    void page_down();
+    void page_up();
+    void scroll_to(size_t index);
+    void scroll_to_top() { scroll_to(0); }
+    void scroll_to_bottom();
+    void ensure_visible(size_t index);
+    // Row heights are cached, call these when the provider reports a different height for rows it already had
+    void invalidate_row(size_t index);
+    void invalidate_heights();
+    // Arrows, page up/down, home/end and mouse wheel
+    void handle_input(const Input& input);
+    void draw();
+
+   public:
+    size_t get_count() const { return m_count; }
+    size_t get_first_visible() const { return m_top; }
+    size_t get_last_visible() const;
+    // Row at a screen row of the viewport, for mouse hit testing
+    std::optional<size_t> row_at(int y) const;
+
+   private:
+    void sync();
+    int row_height(size_t index) const;
+    int64_t offset_of(size_t index) const;
+    size_t index_at(int64_t offset) const;
+    size_t top_for_end(int64_t end_offset) const;
+    void add_height(size_t index, int64_t delta);
+    void append_row(size_t index);
+
+   private:
+    RowProvider m_provider;
+    int m_x = 0;
+    int m_y = 0;
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_top = 0;
+    size_t m_count = 0;
+    // 1-based Fenwick tree of the row heights, empty when all rows are one cell high
+    std::vector<int64_t> m_tree;
+};
+
+}  // namespace TUIE
@@ -0,0 +1,138 @@
+#include "Search.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace TUIE {
+
+void Search::start(std::string query) {
+    cancel();
+    {
+        std::lock_guard lock(m_mutex);
+        m_query = std::move(query);
+        m_matches.clear();
+        m_truncated = false;
+        m_scanned = 0;
+    }
+    run(0);
+}
+
+void Search::run(uint64_t from) {
+    if (m_query.empty() || m_truncated) return;
+    {
+        std::lock_guard lock(m_mutex);
+        m_complete = false;
+    }
+    m_thread = std::jthread(
+        [this, query = m_query, from](std::stop_token stop_token) { scan(stop_token, query, from); });
+}
+
+void Search::append(std::string_view data) {
+    cancel();
+    m_data = data;
+    run(m_scanned);
+}
+
+void Search::reset(std::string_view data) {
+    cancel();
+    m_data = data;
+    start(m_query);
+}
+
+void Search::cancel() {
+    if (m_thread.joinable()) {
+        m_thread.request_stop();
+        m_thread.join();
+    }
+    std::lock_guard lock(m_mutex);
+    m_complete = true;
+}
+
+void Search::scan(std::stop_token stop_token, std::string query, uint64_t from) {
+    // memchr (vectorized in libc) skips to each candidate first byte and memcmp checks the rest. The matches of every
+    // chunk are published together and the stop request is checked between chunks.
+    constexpr size_t CHUNK_SIZE = 1 << 20;
+    const char* const begin = m_data.data();
+    const char* const end = begin + m_data.size();
+    const char first = query[0];
+    std::vector<uint64_t> batch;
+
+    for (const char* chunk = begin + from; chunk < end && !stop_token.stop_requested(); chunk += CHUNK_SIZE) {
+        const char* chunk_end = std::min(chunk + CHUNK_SIZE, end);
+        batch.clear();
+        for (const char* it = chunk; it < chunk_end;) {
+            const char* candidate = static_cast<const char*>(std::memchr(it, first, chunk_end - it));
+            if (candidate == nullptr) break;
+            if (static_cast<size_t>(end - candidate) >= query.size() &&
+                std::memcmp(candidate, query.data(), query.size()) == 0) {
+                batch.push_back(candidate - begin);
+            }
+            it = candidate + 1;
+        }
+
+        std::lock_guard lock(m_mutex);
+        // The last bytes cannot start a match yet, but they can once more data is appended
+        if (chunk_end < end) {
+            m_scanned = chunk_end - begin;
+        } else {
+            const uint64_t incomplete = std::min(m_data.size(), query.size() - 1);
+            m_scanned = std::max<uint64_t>(chunk - begin, m_data.size() - incomplete);
+        }
+        const size_t room = m_match_limit - m_matches.size();
+        m_matches.insert(m_matches.end(), batch.begin(), batch.begin() + std::min(room, batch.size()));
+        if (batch.size() > room) {
+            m_truncated = true;
+            break;
+        }
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_complete = true;
+}
+
+size_t Search::match_count() const {
+    std::lock_guard lock(m_mutex);
+    return m_matches.size();
+}
+
+bool Search::is_complete() const {
+    std::lock_guard lock(m_mutex);
+    return m_complete;
+}
+
+bool Search::is_truncated() const {
+    std::lock_guard lock(m_mutex);
+    return m_truncated;
+}
+
+void Search::matches_in(uint64_t begin, uint64_t end, std::vector<uint64_t>& out) const {
+    std::lock_guard lock(m_mutex);
+    auto first = std::lower_bound(m_matches.begin(), m_matches.end(), begin);
+    auto last = std::lower_bound(first, m_matches.end(), end);
+    out.insert(out.end(), first, last);
+}
+
+std::optional<uint64_t> Search::match_overlapping(uint64_t begin) const {
+    std::lock_guard lock(m_mutex);
+    auto it = std::lower_bound(m_matches.begin(), m_matches.end(), begin);
+    if (it == m_matches.begin()) return std::nullopt;
+    --it;
+    if (*it + m_query.size() > begin) return *it;
+    return std::nullopt;
+}
+
+std::optional<uint64_t> Search::next_match(uint64_t offset) const {
+    std::lock_guard lock(m_mutex);
+    auto it = std::lower_bound(m_matches.begin(), m_matches.end(), offset);
+    if (it == m_matches.end()) return std::nullopt;
+    return *it;
+}
+
+std::optional<uint64_t> Search::previous_match(uint64_t offset) const {
+    std::lock_guard lock(m_mutex);
+    auto it = std::lower_bound(m_matches.begin(), m_matches.end(), offset);
+    if (it == m_matches.begin()) return std::nullopt;
+    return *(--it);
+}
+
+}  // namespace TUIE
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace TUIE {
+
+// Literal substring search over a text buffer on a background thread. Matches are published in batches while the scan
+// runs, so callers can use the first results right away, and a new query cancels and restarts the scan.
+class Search {
+   public:
+    explicit Search(std::string_view data) : m_data(data) {}
+    ~Search() { cancel(); }
+    Search(const Search&) = delete;
+    Search& operator=(const Search&) = delete;
+
+   public:
+    void start(std::string query);
+    void cancel();
+    // Data that extends the searched one (a file that grew): the scan continues where it was, over the new bytes only
+    void append(std::string_view data);
+    // Unrelated data (a file truncated or replaced): the current query is searched again from scratch
+    void reset(std::string_view data);
+    // Stop storing matches after this many, it bounds the memory of very frequent queries
+    void set_match_limit(size_t limit) { m_match_limit = limit; }
+
+   public:
+    const std::string& get_query() const { return m_query; }
+    size_t match_count() const;
+    bool is_complete() const;
+    bool is_truncated() const;
+    // Offsets of the matches that start in [begin, end), appended to out
+    void matches_in(uint64_t begin, uint64_t end, std::vector<uint64_t>& out) const;
+    // A match that starts at or before begin but reaches into the range, if any
+    std::optional<uint64_t> match_overlapping(uint64_t begin) const;
+    // First match at or after offset, and last match before offset
+    std::optional<uint64_t> next_match(uint64_t offset) const;
+    std::optional<uint64_t> previous_match(uint64_t offset) const;
+
+   private:
+    void scan(std::stop_token stop_token, std::string query, uint64_t from);
+    void run(uint64_t from);
+
+   private:
+    std::string_view m_data;
+    std::string m_query;
+    size_t m_match_limit = 1 << 20;
+
+    mutable std::mutex m_mutex;
+    std::vector<uint64_t> m_matches;
+    bool m_complete = true;
+    // Every match that starts before this offset has already been found
+    uint64_t m_scanned = 0;
+    bool m_truncated = false;
+    std::jthread m_thread;
+};
+
+}  // namespace TUIE
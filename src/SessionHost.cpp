@@ -0,0 +1,313 @@
+#include "SessionHost.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "Trace.hpp"
+
+namespace TUIE {
+
+namespace {
+
+// The epoll data of the wake eventfd, session ids start at 1
+constexpr uint64_t WAKE_ID = 0;
+
+std::chrono::steady_clock::rep now_ticks() { return std::chrono::steady_clock::now().time_since_epoch().count(); }
+
+}  // namespace
+
+Session::Session(SessionHost& host, uint64_t id, int input_fd, int output_fd, Update update)
+    : m_host(host), m_id(id), m_input_fd(input_fd), m_update(std::move(update)), m_engine(input_fd, output_fd) {}
+
+void Session::request_redraw() { m_host.wake(*this); }
+
+SessionHost::SessionHost(unsigned workers, int fps)
+    : m_worker_count(std::max(workers, 1u)),
+      m_frame_interval(std::chrono::nanoseconds(1000000000) / std::max(fps, 1)),
+      m_queues(m_worker_count) {
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd < 0) {
+        throw std::runtime_error(std::string("Could not create epoll: ") + std::strerror(errno));
+    }
+    m_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_wake_fd < 0) {
+        close(m_epoll_fd);
+        throw std::runtime_error(std::string("Could not create eventfd: ") + std::strerror(errno));
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_ID;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &event);
+
+    // A session whose socket is gone must not kill the whole process on the next write
+    std::signal(SIGPIPE, SIG_IGN);
+
+    for (unsigned i = 0; i < m_worker_count; i++) {
+        m_workers.emplace_back([this, i](std::stop_token stop) { run_worker(stop, i); });
+    }
+    m_reactor = std::jthread([this](std::stop_token stop) { run_reactor(stop); });
+}
+
+SessionHost::~SessionHost() {
+    m_reactor.request_stop();
+    eventfd_write(m_wake_fd, 1);
+    m_reactor.join();
+    for (std::jthread& worker : m_workers) {
+        worker.request_stop();
+    }
+    {
+        std::lock_guard lock(m_sleep_mutex);
+    }
+    m_wake_workers.notify_all();
+    m_workers.clear();
+
+    // No thread is left, the engines restore their terminals now
+    m_sessions.clear();
+    close(m_wake_fd);
+    close(m_epoll_fd);
+}
+
+Session& SessionHost::add_session(int input_fd, int output_fd, Session::Update update) {
+    Session* session;
+    {
+        std::lock_guard lock(m_sessions_mutex);
+        const uint64_t id = m_next_id++;
+        auto owned = std::make_unique<Session>(*this, id, input_fd, output_fd, std::move(update));
+        session = owned.get();
+        m_sessions.emplace(id, std::move(owned));
+    }
+    // One shot, so an fd is never reported again while its frame is queued or running. It is armed again after it.
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = session->m_id;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, input_fd, &event) != 0) {
+        const std::string error = std::strerror(errno);
+        remove_session(session->m_id);
+        throw std::runtime_error("Could not watch session input: " + error);
+    }
+    // The first frame draws the initial screen
+    wake(*session);
+    return *session;
+}
+
+size_t SessionHost::get_session_count() const {
+    std::lock_guard lock(m_sessions_mutex);
+    return m_sessions.size();
+}
+
+SessionHostStats SessionHost::get_stats() const { return {m_frames.load(), m_steals.load()}; }
+
+void SessionHost::wake(Session& session) {
+    {
+        std::lock_guard lock(m_requests_mutex);
+        m_wake_requests.push_back(session.m_id);
+    }
+    eventfd_write(m_wake_fd, 1);
+}
+
+Session* SessionHost::find_session(uint64_t id) {
+    std::lock_guard lock(m_sessions_mutex);
+    auto it = m_sessions.find(id);
+    return it == m_sessions.end() ? nullptr : it->second.get();
+}
+
+void SessionHost::remove_session(uint64_t id) {
+    std::unique_ptr<Session> session;
+    {
+        std::lock_guard lock(m_sessions_mutex);
+        auto it = m_sessions.find(id);
+        if (it == m_sessions.end()) return;
+        session = std::move(it->second);
+        m_sessions.erase(it);
+    }
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, session->m_input_fd, nullptr);
+}
+
+void SessionHost::run_reactor(std::stop_token stop) {
+    std::vector<Timer> timers;
+    std::vector<uint64_t> requests;
+    std::vector<uint64_t> closed;
+    epoll_event events[64];
+    while (!stop.stop_requested()) {
+        // Nanosecond timeouts, a millisecond one would round every frame interval of the sessions
+        timespec timeout = {};
+        if (!timers.empty()) {
+            const auto wait = std::max(timers.front().when - std::chrono::steady_clock::now(),
+                                       std::chrono::steady_clock::duration(0));
+            const int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+            timeout = {static_cast<time_t>(nanoseconds / 1000000000), static_cast<long>(nanoseconds % 1000000000)};
+        }
+        const int count =
+            epoll_pwait2(m_epoll_fd, events, std::size(events), timers.empty() ? nullptr : &timeout, nullptr);
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.u64 == WAKE_ID) {
+                eventfd_t value;
+                eventfd_read(m_wake_fd, &value);
+                continue;
+            }
+            if (Session* session = find_session(events[i].data.u64)) {
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    session->m_hangup = true;
+                }
+                want_frame(*session, timers);
+            }
+        }
+
+        {
+            std::lock_guard lock(m_requests_mutex);
+            requests.swap(m_wake_requests);
+            closed.swap(m_closed);
+        }
+        for (uint64_t id : closed) {
+            remove_session(id);
+        }
+        closed.clear();
+        for (uint64_t id : requests) {
+            if (Session* session = find_session(id)) {
+                want_frame(*session, timers);
+            }
+        }
+        requests.clear();
+
+        const auto now = std::chrono::steady_clock::now();
+        while (!timers.empty() && timers.front().when <= now) {
+            const uint64_t id = timers.front().id;
+            std::ranges::pop_heap(timers, std::greater<>());
+            timers.pop_back();
+            if (Session* session = find_session(id)) {
+                session->m_timer_pending = false;
+                dispatch(*session);
+            }
+        }
+    }
+}
+
+void SessionHost::want_frame(Session& session, std::vector<Timer>& timers) {
+    // Frames are capped at the frame rate, requests that come earlier wait for the next slot and are merged
+    const auto last_frame = std::chrono::steady_clock::time_point(
+        std::chrono::steady_clock::duration(session.m_last_frame.load(std::memory_order_relaxed)));
+    const auto next_frame = last_frame + m_frame_interval;
+    if (std::chrono::steady_clock::now() >= next_frame) {
+        dispatch(session);
+    } else if (!session.m_timer_pending) {
+        session.m_timer_pending = true;
+        timers.push_back({std::chrono::time_point_cast<std::chrono::steady_clock::duration>(next_frame),
+                          session.m_id});
+        std::ranges::push_heap(timers, std::greater<>());
+    }
+}
+
+void SessionHost::dispatch(Session& session) {
+    int state = session.m_state.load();
+    while (true) {
+        if (state == Session::IDLE) {
+            if (session.m_state.compare_exchange_weak(state, Session::QUEUED)) break;
+        } else if (state == Session::RUNNING) {
+            // The running frame asks again when it ends
+            if (session.m_state.compare_exchange_weak(state, Session::RUNNING_AGAIN)) return;
+        } else {
+            return;
+        }
+    }
+
+    WorkerQueue& queue = m_queues[m_next_queue];
+    m_next_queue = (m_next_queue + 1) % m_worker_count;
+    // Counted before it is published, a worker can pop the task and decrement the count right after the push
+    m_queued.fetch_add(1);
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(&session);
+    }
+    {
+        std::lock_guard lock(m_sleep_mutex);
+    }
+    m_wake_workers.notify_one();
+}
+
+Session* SessionHost::pop_task(unsigned index) {
+    {
+        // The newest task of its own queue first, its session is the most likely to be warm in the cache
+        WorkerQueue& queue = m_queues[index];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            Session* session = queue.tasks.back();
+            queue.tasks.pop_back();
+            return session;
+        }
+    }
+    // Then the oldest task of the others, starting with the next worker so the steals spread
+    for (unsigned i = 1; i < m_worker_count; i++) {
+        WorkerQueue& queue = m_queues[(index + i) % m_worker_count];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            Session* session = queue.tasks.front();
+            queue.tasks.pop_front();
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return session;
+        }
+    }
+    return nullptr;
+}
+
+void SessionHost::run_worker(std::stop_token stop, unsigned index) {
+    while (!stop.stop_requested()) {
+        Session* session = pop_task(index);
+        if (!session) {
+            std::unique_lock lock(m_sleep_mutex);
+            m_wake_workers.wait(lock, [&]() { return stop.stop_requested() || m_queued.load() > 0; });
+            continue;
+        }
+        m_queued.fetch_sub(1);
+        run_frame(*session);
+    }
+}
+
+void SessionHost::run_frame(Session& session) {
+    TRACE_SCOPE("SessionHost::run_frame");
+    session.m_state = Session::RUNNING;
+    session.m_last_frame.store(now_ticks(), std::memory_order_relaxed);
+
+    engine& engine = session.m_engine;
+    bool open = !session.m_hangup;
+    if (open) {
+        engine.begin_draw();
+        open = session.m_update(engine, session);
+        engine.present();
+        session.m_frames.fetch_add(1, std::memory_order_relaxed);
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!open) {
+        session.m_state = Session::CLOSED;
+        {
+            std::lock_guard lock(m_requests_mutex);
+            m_closed.push_back(session.m_id);
+        }
+        eventfd_write(m_wake_fd, 1);
+        return;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = session.m_id;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, session.m_input_fd, &event);
+
+    int state = Session::RUNNING;
+    const bool asked_again = !session.m_state.compare_exchange_strong(state, Session::IDLE);
+    if (asked_again) {
+        session.m_state = Session::IDLE;
+    }
+    // Asked again while running, or a slow terminal held the frame back and it has to be sent later
+    if (asked_again || engine.has_unsent_frame()) {
+        wake(session);
+    }
+}
+
+}  // namespace TUIE
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "TUIengine.hpp"
+
+namespace TUIE {
+
+class SessionHost;
+
+// One terminal served by a SessionHost. Its frames run on any of the workers, but never two at the same time.
+class Session {
+   public:
+    // Called once per frame between begin_draw and present, returning false ends the session
+    using Update = std::function<bool(engine&, Session&)>;
+
+    Session(SessionHost& host, uint64_t id, int input_fd, int output_fd, Update update);
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+   public:
+    // Asks for another frame, it runs once the frame interval since the previous one has passed. Safe from any
+    // thread, an animated session calls it from its own update.
+    void request_redraw();
+    engine& get_engine() { return m_engine; }
+    uint64_t get_id() const { return m_id; }
+    uint64_t get_frame_count() const { return m_frames.load(std::memory_order_relaxed); }
+
+   private:
+    friend class SessionHost;
+
+    // QUEUED and RUNNING guarantee a single frame at a time, RUNNING_AGAIN remembers a request made during a frame
+    enum State : int { IDLE, QUEUED, RUNNING, RUNNING_AGAIN, CLOSED };
+
+    SessionHost& m_host;
+    uint64_t m_id;
+    int m_input_fd;
+    Update m_update;
+    engine m_engine;
+    std::atomic<int> m_state = IDLE;
+    std::atomic<bool> m_hangup = false;
+    std::atomic<std::chrono::steady_clock::rep> m_last_frame = 0;
+    std::atomic<uint64_t> m_frames = 0;
+    // Only used by the reactor thread
+    bool m_timer_pending = false;
+};
+
+struct SessionHostStats {
+    uint64_t frames;
+    // Frames a worker took from the queue of another worker
+    uint64_t steals;
+};
+
+// Serves many terminal sessions from one process with a fixed pool of workers. A reactor thread waits on the input of
+// every session (epoll), on the frame timers and on redraw requests, and queues a frame task (input decode, update,
+// diff and write) when one of them fires. Every worker runs the tasks of its own queue and steals from the others when
+// it runs dry, so a few expensive sessions do not hold back the rest.
+class SessionHost {
+   public:
+    explicit SessionHost(unsigned workers = std::thread::hardware_concurrency(), int fps = 30);
+    ~SessionHost();
+    SessionHost(const SessionHost&) = delete;
+    SessionHost& operator=(const SessionHost&) = delete;
+
+   public:
+    // The fds are left open. The session ends when its update returns false or its input hangs up.
+    Session& add_session(int input_fd, int output_fd, Session::Update update);
+    size_t get_session_count() const;
+    unsigned get_worker_count() const { return m_worker_count; }
+    SessionHostStats get_stats() const;
+
+   private:
+    friend class Session;
+
+    struct Timer {
+        std::chrono::steady_clock::time_point when;
+        uint64_t id;
+        bool operator>(const Timer& other) const { return when > other.when; }
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Session*> tasks;
+    };
+
+    // Asks the reactor for a frame of the session, from any thread
+    void wake(Session& session);
+    void run_reactor(std::stop_token stop);
+    void want_frame(Session& session, std::vector<Timer>& timers);
+    void dispatch(Session& session);
+    void run_worker(std::stop_token stop, unsigned index);
+    Session* pop_task(unsigned index);
+    void run_frame(Session& session);
+    Session* find_session(uint64_t id);
+    void remove_session(uint64_t id);
+
+   private:
+    unsigned m_worker_count;
+    std::chrono::nanoseconds m_frame_interval;
+    int m_epoll_fd;
+    int m_wake_fd;
+
+    mutable std::mutex m_sessions_mutex;
+    std::unordered_map<uint64_t, std::unique_ptr<Session>> m_sessions;
+    uint64_t m_next_id = 1;
+
+    std::mutex m_requests_mutex;
+    std::vector<uint64_t> m_wake_requests;
+    std::vector<uint64_t> m_closed;
+
+    std::vector<WorkerQueue> m_queues;
+    unsigned m_next_queue = 0;
+    std::atomic<size_t> m_queued = 0;
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake_workers;
+    std::atomic<uint64_t> m_frames = 0;
+    std::atomic<uint64_t> m_steals = 0;
+
+    // Last, so the threads stop before the state they use is destroyed
+    std::vector<std::jthread> m_workers;
+    std::jthread m_reactor;
+};
+
+}  // namespace TUIE
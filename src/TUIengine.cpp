@@ -5,95 +5,337 @@
 #include <sys/ioctl.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cmath>
 #include <csignal>
+#include <cstdlib>
+#include <ctime>
 #include <thread>
 
+#include "Fill.hpp"
+#include "Renderer.hpp"
 #include "Terminal.hpp"
 #include "TerminalBuffer.hpp"
+#include "Trace.hpp"
 #include "debug.hpp"
 
 namespace TUIE {
 
-engine::engine()
-    : m_terminal(),
+namespace {
+
+// steady_clock is CLOCK_MONOTONIC, an absolute sleep does not drift by the time it takes to compute the duration
+void sleep_until(std::chrono::steady_clock::time_point deadline) {
+    const auto since_epoch = deadline.time_since_epoch();
+    if (since_epoch <= std::chrono::steady_clock::now().time_since_epoch()) return;
+    const timespec time = {static_cast<time_t>(std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count()),
+                           static_cast<long>(std::chrono::nanoseconds(since_epoch % std::chrono::seconds(1)).count())};
+    // Restarted after a signal (SIGWINCH), the deadline does not move
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr) == EINTR) {
+    }
+}
+
+}  // namespace
+
+engine::engine(int input_fd, int output_fd)
+    : m_output_fd(output_fd),
+      m_out(m_output_fd.get()),
+      m_input(input_fd),
+      m_capabilities(input_fd == STDIN_FILENO),
+      m_terminal(input_fd, m_output_fd.get(), m_out, m_capabilities.get()),
+      m_resize_generation(Terminal::get_resize_generation()),
       m_buffer{TerminalBuffer(m_terminal.size.width, m_terminal.size.height),
                TerminalBuffer(m_terminal.size.width, m_terminal.size.height)} {
-    std::signal(SIGINT, exit);
+    m_frame_stats.fps = m_fps;
+    m_capabilities.start(m_terminal);
+    m_out.flush();
+    // Process wide settings only belong to the terminal of the process
+    if (input_fd == STDIN_FILENO) {
+        std::signal(SIGINT, exit);
+        if (const char* record_path = std::getenv("TUIE_RECORD")) {
+            m_pending_recording = record_path;
+            m_pending_recording_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        }
+    }
 }
 
 TerminalSize engine::get_terminal_size() { return m_terminal.size; }
 
 void engine::on_resize() { m_resize_flag = true; }
 
+void engine::start_recording(const std::string& path) {
+    m_recorder = std::make_unique<Recorder>(path, m_capabilities.get().palette);
+    m_input.set_recorder(m_recorder.get());
+}
+
+void engine::stop_recording() {
+    m_input.set_recorder(nullptr);
+    m_recorder.reset();
+}
+
+void engine::watch_fd(int fd, std::function<void()> callback) {
+    unwatch_fd(fd);
+    m_fd_watches.push_back({fd, std::move(callback)});
+}
+
+void engine::unwatch_fd(int fd) {
+    std::erase_if(m_fd_watches, [fd](const FdWatch& watch) { return watch.fd == fd; });
+}
+
+void engine::wait_until(std::chrono::steady_clock::time_point deadline) {
+    TRACE_SCOPE("engine::wait_until");
+    // The sleep ends a bit before the deadline when spinning, the rest is spun
+    const auto sleep_deadline = deadline - m_frame_pacing.spin;
+    // The watched fds are checked at least once per frame, even when there is no time left to sleep
+    do {
+        m_pollfds.clear();
+        for (const FdWatch& watch : m_fd_watches) {
+            m_pollfds.push_back({watch.fd, POLLIN, 0});
+        }
+        // A backed up output is sent as soon as the terminal takes more, which also times the drain precisely
+        if (m_out.backlog_size() > 0) {
+            m_pollfds.push_back({m_out.get_fd(), POLLOUT, 0});
+        }
+        // Woken up for the timers due before the frame, so they run on time and not with the next frame
+        const auto wake = std::min<std::chrono::steady_clock::time_point>(sleep_deadline, m_timers.next_deadline());
+        if (m_pollfds.empty()) {
+            sleep_until(wake);
+        } else {
+            const std::chrono::nanoseconds until_wake = wake - std::chrono::steady_clock::now();
+            const std::chrono::nanoseconds remaining = std::max(until_wake, std::chrono::nanoseconds(0));
+            const timespec timeout = {static_cast<time_t>(remaining.count() / 1000000000),
+                                      static_cast<long>(remaining.count() % 1000000000)};
+            if (ppoll(m_pollfds.data(), m_pollfds.size(), &timeout, nullptr) > 0) {
+                for (const pollfd& pollfd : m_pollfds) {
+                    if (pollfd.revents == 0) continue;
+                    if (pollfd.events == POLLOUT) {
+                        flush_output();
+                        continue;
+                    }
+                    // The callback can change the watches, so it is looked up again for every ready fd
+                    auto it = std::find_if(m_fd_watches.begin(), m_fd_watches.end(),
+                                           [&](const FdWatch& watch) { return watch.fd == pollfd.fd; });
+                    if (it != m_fd_watches.end()) {
+                        auto callback = it->callback;
+                        callback();
+                    }
+                }
+            }
+        }
+        m_timers.advance();
+    } while (std::chrono::steady_clock::now() < sleep_deadline);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void engine::run() {
+    while (m_scheduler.get_task_count() > 0) {
+        begin_draw();
+        if (window_should_close()) break;
+        m_scheduler.run_frame(m_input.get_events());
+        end_draw();
+    }
+}
+
+void engine::enable_kitty_keyboard(bool enable) {
+    m_kitty_keyboard_requested = enable;
+    update_keyboard_protocol();
+    m_out.flush();
+}
+
+void engine::update_keyboard_protocol() {
+    const bool enable = m_kitty_keyboard_requested && m_capabilities.get().kitty_keyboard;
+    if (enable == m_input.is_kitty_keyboard()) return;
+    if (enable) {
+        m_terminal.push_keyboard_flags(KITTY_KEYBOARD_FLAGS);
+    } else {
+        m_terminal.pop_keyboard_flags();
+    }
+    m_input.set_kitty_keyboard(enable);
+}
+
 bool engine::window_should_close() { return m_input.is_key_pressed(KEYS::ESCAPE) || m_input.is_key_pressed('q'); }
 
-void engine::set_fps(int fps) { this->m_fps = fps; }
+void engine::set_fps(int fps) {
+    this->m_fps = fps;
+    // The deadlines and the measure start over from the next frame with the new period
+    m_next_frame = {};
+    m_frame_window = {};
+    m_frame_stats.fps = fps;
+}
 
-void engine::clear_background(Color color) { draw_rect(0, 0, m_terminal.size.width, m_terminal.size.height, color); }
+void engine::clear_background(Color color) {
+    TerminalBuffer& target = get_draw_target();
+    draw_rect(0, 0, target.get_width(), target.get_height(), color);
+}
 
 void engine::begin_draw() {
-    debug_msg("Begin draw");
-    m_start_frame_time = std::chrono::high_resolution_clock::now();
-    if (m_resize_flag) {
+    TRACE_SCOPE("engine::begin_draw");
+    log_msg(LogCategory::ENGINE, LogLevel::VERBOSE, "Begin draw");
+    const uint32_t resize_generation = Terminal::get_resize_generation();
+    if (m_resize_flag.exchange(false) || resize_generation != m_resize_generation) {
+        m_resize_generation = resize_generation;
         m_terminal.on_resize();
         m_buffer[m_current_buffer].resize(m_terminal.size.width, m_terminal.size.height);
-        m_resize_flag = false;
     }
+    m_timers.advance();
     m_input.clear_events();
     m_input.process_input();
+    TRACE_COUNTER("input events", m_input.get_events().size());
+    for (const TerminalReport& report : m_input.get_reports()) {
+        if (m_capabilities.on_report(report)) {
+            m_terminal.apply_capabilities(m_capabilities.get());
+            update_keyboard_protocol();
+        }
+    }
+    if (!m_pending_recording.empty() &&
+        (m_capabilities.is_complete() || std::chrono::steady_clock::now() >= m_pending_recording_deadline)) {
+        start_recording(m_pending_recording);
+        m_pending_recording.clear();
+    }
 }
 
-void engine::end_draw() {
+void engine::present() {
+    TRACE_SCOPE("engine::present");
+    if (m_recorder) {
+        m_recorder->record_frame(get_current_buffer());
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (!flush_output() || now < m_next_present) {
+        // The current buffer keeps this frame and the back buffer keeps what was sent, so the next frame sent is one
+        // diff that also carries the changes of the skipped ones
+        m_unsent_frame = true;
+        m_skipped_frames++;
+        TRACE_INSTANT("skipped frame");
+        return;
+    }
+    m_unsent_frame = false;
+    const size_t queued_before = m_out.bytes_sent() + m_out.backlog_size();
     draw_buffer();
     m_current_buffer = next_buffer_index();
-    fixedCout.flush();
-    const auto target_time = std::chrono::microseconds(1000000 / m_fps);
-    const auto sleep_time = target_time - (std::chrono::high_resolution_clock::now() - m_start_frame_time);
-    m_real_fps =
-        1000.0f / (std::chrono::duration_cast<std::chrono::microseconds>(target_time - sleep_time).count() / 1000.0f);
-    debug_msg("End draw sleep for "
-              << std::chrono::duration_cast<std::chrono::microseconds>(sleep_time).count() / 1000.0 << "ms used "
-              << std::chrono::duration_cast<std::chrono::microseconds>(target_time - sleep_time).count() / 1000.0
-              << "ms");
-    if (sleep_time.count() > 0) {
-        std::this_thread::sleep_for(sleep_time);
+    m_out.flush();
+    TRACE_COUNTER("frame bytes", m_out.bytes_sent() + m_out.backlog_size() - queued_before);
+
+    if (m_out.backlog_size() > 0 && !m_congested) {
+        m_congested = true;
+        m_congested_since = now;
+        m_congested_bytes = m_out.bytes_sent();
     }
+    if (m_output_rate > 0) {
+        if (!m_congested && now >= m_next_rate_probe) {
+            // Probe for a faster link once per second, up to a few times the last measure. A link that got that much
+            // faster is measured again the next time it backs up.
+            m_output_rate = std::min(m_output_rate * 1.25, m_measured_rate * MAX_RATE_PROBE);
+            m_next_rate_probe = now + std::chrono::seconds(1);
+        }
+        // Paced a bit below the measured rate, so what queued in the kernel drains and the latency stays bounded
+        const double frame_bytes = m_out.bytes_sent() + m_out.backlog_size() - queued_before;
+        m_next_present = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                   std::chrono::duration<double>(frame_bytes / (m_output_rate * 0.8)));
+    }
+}
+
+bool engine::flush_output() {
+    const bool drained = m_out.flush_backlog();
+    if (m_congested && drained) {
+        // The backlog only builds once the kernel buffers are full, so the time it took to drain measures the link
+        m_congested = false;
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_congested_since;
+        if (elapsed.count() > 0) {
+            const double rate = (m_out.bytes_sent() - m_congested_bytes) / elapsed.count();
+            m_measured_rate = m_measured_rate > 0 ? (m_measured_rate + rate) / 2 : rate;
+            m_output_rate = m_measured_rate;
+            m_next_rate_probe = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        }
+    }
+    return drained;
+}
+
+void engine::end_draw() {
+    present();
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::nanoseconds(1000000000) / std::max(m_fps, 1));
+    const auto now = std::chrono::steady_clock::now();
+    if (m_next_frame == std::chrono::steady_clock::time_point()) {
+        m_next_frame = now;
+    }
+    // On the grid of the first deadline, however long the frame took
+    m_next_frame += period;
+    if (m_next_frame < now) {
+        const auto behind = now - m_next_frame;
+        if (m_frame_pacing.late_frames == LateFrames::SKIP) {
+            const auto missed = behind / period + 1;
+            m_next_frame += missed * period;
+            m_frame_stats.missed_frames += missed;
+        } else if (behind > m_frame_pacing.max_catch_up_frames * period) {
+            m_next_frame = now;
+        }
+    }
+    log_msg(LogCategory::ENGINE, LogLevel::VERBOSE,
+            "End draw sleep for "
+                << std::chrono::duration_cast<std::chrono::microseconds>(m_next_frame - now).count() / 1000.0 << "ms");
+    wait_until(m_next_frame);
+    update_frame_stats(m_next_frame);
+}
+
+void engine::update_frame_stats(std::chrono::steady_clock::time_point deadline) {
+    const auto now = std::chrono::steady_clock::now();
+    FrameWindow& window = m_frame_window;
+    if (window.last == std::chrono::steady_clock::time_point()) {
+        window.start = now;
+    } else {
+        const double interval = std::chrono::duration<double>(now - window.last).count();
+        window.intervals++;
+        window.interval_sum += interval;
+        window.interval_squares += interval * interval;
+    }
+    window.last = now;
+    window.max_late = std::max(window.max_late, std::chrono::duration<double>(now - deadline).count());
+    if (now - window.start < std::chrono::seconds(1) || window.intervals == 0) return;
+
+    const double mean = window.interval_sum / window.intervals;
+    const double variance = window.interval_squares / window.intervals - mean * mean;
+    m_frame_stats.fps = window.intervals / window.interval_sum;
+    m_frame_stats.jitter_ms = std::sqrt(std::max(variance, 0.0)) * 1000;
+    m_frame_stats.max_late_ms = window.max_late * 1000;
+    window = {now, now};
 }
 
 void engine::draw_text(int x, int y, std::string_view text) {
-    TerminalBuffer& current_buffer = get_current_buffer();
-    for (int i = 0; i < text.size(); i++) {
+    TerminalBuffer& current_buffer = get_draw_target();
+    for (int i = 0; !text.empty(); i++) {
         if (!current_buffer.is_inside(x + i, y)) {
             break;
         }
-        current_buffer.set_character(x + i, y, text[i]);
+        current_buffer.set_character(x + i, y, pop_utf8(text));
     }
 }
 
 void engine::draw_text(int x, int y, std::string_view text, Color foreground_color) {
-    TerminalBuffer& current_buffer = get_current_buffer();
-    for (int i = 0; i < text.size(); i++) {
+    TerminalBuffer& current_buffer = get_draw_target();
+    for (int i = 0; !text.empty(); i++) {
         if (!current_buffer.is_inside(x + i, y)) {
             break;
         }
-        current_buffer.set_character(x + i, y, text[i]);
+        current_buffer.set_character(x + i, y, pop_utf8(text));
         current_buffer.set_foreground_color(x + i, y, foreground_color);
     }
 }
 
 void engine::draw_text(int x, int y, std::string_view text, Color foreground_color, Color background_color) {
-    TerminalBuffer& current_buffer = get_current_buffer();
-    for (int i = 0; i < text.size(); i++) {
+    TerminalBuffer& current_buffer = get_draw_target();
+    for (int i = 0; !text.empty(); i++) {
         if (!current_buffer.is_inside(x + i, y)) {
             break;
         }
-        current_buffer.set_cell(x + i, y, TerminalCell{text[i], foreground_color, background_color});
+        current_buffer.set_cell(x + i, y, TerminalCell{pop_utf8(text), foreground_color, background_color});
     }
 }
 
-void engine::draw_rect(int x, int y, int width, int height, Color color, char character, Color character_color) {
-    TerminalBuffer& current_buffer = get_current_buffer();
+void engine::draw_rect(int x, int y, int width, int height, Color color, char32_t character, Color character_color) {
+    TerminalBuffer& current_buffer = get_draw_target();
     for (int i = 0; i < height; i++) {
         for (int j = 0; j < width; j++) {
             if (!current_buffer.is_inside(x + j, y + i)) {
@@ -104,58 +346,41 @@ void engine::draw_rect(int x, int y, int width, int height, Color color, char ch
     }
 }
 
+void engine::draw_linear_gradient(Rect rect, Color from, Color to, float angle) {
+    fill_linear_gradient(get_draw_target(), rect, from, to, angle);
+}
+
+void engine::draw_radial_gradient(Rect rect, Color inner, Color outer) {
+    fill_radial_gradient(get_draw_target(), rect, inner, outer);
+}
+
+void engine::draw_checkerboard(Rect rect, Color first, Color second, int cell_width, int cell_height) {
+    fill_checkerboard(get_draw_target(), rect, first, second, cell_width, cell_height);
+}
+
+void engine::draw_stripes(Rect rect, Color first, Color second, int width, bool vertical) {
+    fill_stripes(get_draw_target(), rect, first, second, width, vertical);
+}
+
+void engine::shade_rect(Rect rect, Color color, uint8_t alpha) { shade(get_draw_target(), rect, color, alpha); }
+
+void engine::blit(const TerminalBuffer& source, Rect source_rect, int x, int y, BlitMode mode, Color key) {
+    get_draw_target().blit(source, source_rect, x, y, mode, key);
+}
+
 TerminalBuffer& engine::get_current_buffer() { return m_buffer[m_current_buffer]; }
+TerminalBuffer& engine::get_draw_target() { return m_render_target ? *m_render_target : get_current_buffer(); }
 TerminalBuffer& engine::get_back_buffer() { return m_buffer[next_buffer_index()]; }
 int engine::next_buffer_index() { return (m_current_buffer + 1) % 2; }
 
 void engine::draw_buffer() {
-    // This function compare the current buffer with the previous buffer and only prints the changes
+    TRACE_SCOPE("engine::draw_buffer");
     TerminalBuffer& current_buffer = get_current_buffer();
     TerminalBuffer& previous_buffer = get_back_buffer();
-
-    bool first_bg = false, first_fg = false;
-    Color last_bg = {0, 0, 0};
-    Color last_fg = {0, 0, 0};
-    bool cursor_moved = true;
-
-    debug_msg("Drawing previous buffer\n" << previous_buffer);
-    debug_msg("Drawing buffer\n" << current_buffer);
-    m_terminal.reset_cursor();
-    m_terminal.reset_colors();
-    for (int y = 0; y < current_buffer.get_height(); y++) {
-        for (int x = 0; x < current_buffer.get_width(); x++) {
-            const TerminalCell current_cell = current_buffer.get_cell(x, y);
-            bool cells_equal = false;
-            if (previous_buffer.is_inside(x, y)) {
-                cells_equal = current_cell == previous_buffer.get_cell(x, y);
-            }
-
-            if (!cells_equal) {
-                if (cursor_moved) {
-                    m_terminal.set_cursor_position(x + 1, y + 1);
-                    cursor_moved = false;
-                    debug_msg("Cursor moved to " << x << ", " << y + 1);
-                }
-                if (current_cell.background_color != last_bg || !first_bg) {
-                    m_terminal.set_background_color(current_cell.background_color);
-                    last_bg = current_cell.background_color;
-                    first_bg = true;
-                    debug_msg("Background color changed to " << current_cell.background_color);
-                }
-                if (current_cell.foreground_color != last_fg || !first_fg) {
-                    m_terminal.set_foreground_color(current_cell.foreground_color);
-                    last_fg = current_cell.foreground_color;
-                    first_fg = true;
-                    debug_msg("Foreground color changed to " << current_cell.foreground_color);
-                }
-                fixedCout << current_cell.character;
-                debug_msg("Character printed '" << current_cell.character << "' at " << x << ", " << y);
-            } else {
-                cursor_moved = true;
-            }
-        }
-        cursor_moved = true;
-    }
+    const Capabilities& capabilities = m_capabilities.get();
+    if (capabilities.synchronized_output) m_terminal.begin_synchronized_update();
+    Renderer(m_out, capabilities.palette).draw(previous_buffer, current_buffer);
+    if (capabilities.synchronized_output) m_terminal.end_synchronized_update();
     previous_buffer = current_buffer;
 }
 
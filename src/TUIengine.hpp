@@ -1,22 +1,70 @@
 #pragma once
 
+#include <poll.h>
+#include <unistd.h>
+
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "Capabilities.hpp"
 #include "Color.hpp"
 #include "FixedOStream.hpp"
 #include "Input.hpp"
+#include "Recorder.hpp"
+#include "Scheduler.hpp"
 #include "Terminal.hpp"
 #include "TerminalBuffer.hpp"
+#include "TimerWheel.hpp"
 
 namespace TUIE {
 
-class engine {
-   private:
-    explicit engine();
+// What end_draw does when a frame ends after the deadline of the next one
+enum class LateFrames {
+    // Waits for the next frame boundary: the missed frames are dropped and the frames keep their phase
+    SKIP,
+    // Starts the late frames right away until they are back on schedule, so what advances once per frame keeps its
+    // pace. Beyond max_catch_up_frames behind, the schedule restarts from now.
+    CATCH_UP,
+};
 
+// The frames start on absolute deadlines one period apart, so neither the time spent between end_draw and begin_draw
+// nor the oversleeping of the kernel adds up from frame to frame
+struct FramePacing {
+    LateFrames late_frames = LateFrames::SKIP;
+    int max_catch_up_frames = 4;
+    // The end of the wait is spun instead of slept, a sleep wakes up tens of microseconds late or more. It costs CPU,
+    // 0 only sleeps.
+    std::chrono::microseconds spin{0};
+};
+
+// Measured over windows of about a second of frames
+struct FrameStats {
+    // Frames started per second
+    float fps;
+    // Standard deviation of the time between frame starts
+    float jitter_ms;
+    // Latest frame start after its deadline
+    float max_late_ms;
+    // Dropped by LateFrames::SKIP since the start
+    uint64_t missed_frames;
+};
+
+class engine {
    public:
+    // An engine drawing to the terminal behind an fd pair (a pty, a socket), so one process can serve many terminals.
+    // The fds are left open. Each engine only holds its two buffers and small fixed input and output buffers.
+    engine(int input_fd, int output_fd);
+    engine(const engine&) = delete;
+    engine& operator=(const engine&) = delete;
+
+    // The engine of the terminal of the process (stdin/stdout)
     static engine& instance() {
-        static engine instance;
+        static engine instance(STDIN_FILENO, STDOUT_FILENO);
         return instance;
     }
 
@@ -25,37 +73,141 @@ class engine {
     bool window_should_close();
     void set_fps(int fps);
     int get_target_fps() const { return m_fps; }
-    float get_real_fps() const { return m_real_fps; }
+    // Measured over the last second of frames, the target fps until a second was measured
+    float get_real_fps() const { return m_frame_stats.fps; }
+    void set_frame_pacing(FramePacing pacing) { m_frame_pacing = pacing; }
+    const FramePacing& get_frame_pacing() const { return m_frame_pacing; }
+    const FrameStats& get_frame_stats() const { return m_frame_stats; }
     void clear_background(Color color);
     void begin_draw();
     void end_draw();
+    // The drawing half of end_draw, without waiting for the next frame. For callers that pace the frames themselves.
+    // While the terminal has not taken the previous frames the frame is not sent, see has_unsent_frame.
+    void present();
+    // The last frame was held back by a slow terminal. It goes out with the next present, as one diff against what the
+    // terminal already has, so callers that only draw on changes present again later.
+    bool has_unsent_frame() const { return m_unsent_frame; }
+    uint64_t get_skipped_frames() const { return m_skipped_frames; }
+    // Bytes per second the terminal took the last time the output backed up, 0 before it ever did
+    double get_output_rate() const { return m_measured_rate; }
+    // The frames are wrapped in synchronized updates once the terminal answers that it supports them (DEC mode 2026).
+    // Terminals that do not answer get the plain output.
+    bool is_synchronized_output() const { return m_capabilities.get().synchronized_output; }
+    // Probed at startup, or read from the cache for the terminal of the process. The frames use its palette.
+    const Capabilities& get_capabilities() const { return m_capabilities.get(); }
+    // Opts in to the kitty keyboard protocol, used once the probe finds the terminal supports it: unambiguous ESC,
+    // modifiers on every key and repeat/release events. Other terminals keep the legacy input.
+    void enable_kitty_keyboard(bool enable);
+    // The text is UTF-8, every code point takes one cell
     void draw_text(int x, int y, std::string_view text);
     void draw_text(int x, int y, std::string_view text, Color foreground_color);
     void draw_text(int x, int y, std::string_view text, Color foreground_color, Color background_color);
-    void draw_rect(int x, int y, int width, int height, Color color, char character = ' ',
+    void draw_rect(int x, int y, int width, int height, Color color, char32_t character = U' ',
                    Color character_color = TUIE::BLACK);
+    // Gradient and pattern fills, see Fill.hpp
+    void draw_linear_gradient(Rect rect, Color from, Color to, float angle = 0);
+    void draw_radial_gradient(Rect rect, Color inner, Color outer);
+    void draw_checkerboard(Rect rect, Color first, Color second, int cell_width = 2, int cell_height = 1);
+    void draw_stripes(Rect rect, Color first, Color second, int width = 1, bool vertical = true);
+    void shade_rect(Rect rect, Color color, uint8_t alpha);
+    // Copies the source_rect of source to x, y clipped to the draw target, see BlitMode for how the cells are combined
+    void blit(const TerminalBuffer& source, Rect source_rect, int x, int y, BlitMode mode = BlitMode::OPAQUE,
+              Color key = TERMINAL_COLOR);
+    // Redirects the draw calls to an off-screen buffer, nullptr draws to the terminal again
+    void set_render_target(TerminalBuffer* target) { m_render_target = target; }
+    TerminalBuffer* get_render_target() const { return m_render_target; }
 
    public:
+    // Reads the terminal size again on the next frame. The stdio engine also does it on SIGWINCH, for other terminals
+    // their owner calls it (for a pty, after changing its window size).
     void on_resize();
+    // Records every frame and the raw input to a file that can be replayed offline (see examples/replay.cpp). It is
+    // also started when the TUIE_RECORD environment variable names a file, once the capability probe completes (or
+    // after a second without answer) so the recorded palette is the one the frames are sent with.
+    void start_recording(const std::string& path);
+    void stop_recording();
+    // Calls back when fd becomes readable. The fds are waited on while the engine sleeps between frames, so event
+    // sources (inotify, sockets, pipes) are handled without polling them every frame.
+    void watch_fd(int fd, std::function<void()> callback);
+    void unwatch_fd(int fd);
+    // Starts a task on the next frame of run. Tasks draw with the engine and co_await next_frame(), input.key() or
+    // sleep(duration) instead of keeping their own state machines.
+    void spawn(Task task) { m_scheduler.spawn(std::move(task)); }
+    FrameAwaiter next_frame() const { return {}; }
+    // Runs the frames until every task finished or the window should close, resuming the tasks once per frame
+    void run();
+    // Timers run at the start of every frame, and also while the engine sleeps between frames when they are due before
+    // the next one
+    TimerWheel& get_timers() { return m_timers; }
 
    private:
     void draw_buffer();
     TerminalBuffer& get_current_buffer();
+    TerminalBuffer& get_draw_target();
     TerminalBuffer& get_back_buffer();
     int next_buffer_index();
+    void wait_until(std::chrono::steady_clock::time_point deadline);
+    void update_frame_stats(std::chrono::steady_clock::time_point deadline);
+    void update_keyboard_protocol();
+    bool flush_output();
 
    public:
     Input& get_input() { return m_input; }
 
    private:
+    // Closed after the output stream and the terminal flushed the last bytes to it
+    OutputFd m_output_fd;
+    FixedOStream<4096> m_out;
     Input m_input;
+    CapabilityProbe m_capabilities;
+    bool m_kitty_keyboard_requested = false;
     Terminal m_terminal;
     int m_fps = 30;
-    float m_real_fps = 30.0f;
-    std::chrono::high_resolution_clock::time_point m_start_frame_time;
-    bool m_resize_flag = false;
+    FramePacing m_frame_pacing;
+    // Deadline of the next frame, unset until the first frame or after a change of fps
+    std::chrono::steady_clock::time_point m_next_frame;
+    FrameStats m_frame_stats = {};
+    std::atomic<bool> m_resize_flag = false;
+    uint32_t m_resize_generation;
     TerminalBuffer m_buffer[2];
     int m_current_buffer = 0;
+    TerminalBuffer* m_render_target = nullptr;
+    std::unique_ptr<Recorder> m_recorder;
+    std::string m_pending_recording;
+    std::chrono::steady_clock::time_point m_pending_recording_deadline;
+
+    // Output backpressure: while the output is backed up the drain is timed, then frames are paced below that rate
+    bool m_unsent_frame = false;
+    uint64_t m_skipped_frames = 0;
+    // Rate the frames are paced at, and the average of the drains measured
+    double m_output_rate = 0;
+    double m_measured_rate = 0;
+    static constexpr double MAX_RATE_PROBE = 4;
+    std::chrono::steady_clock::time_point m_next_rate_probe;
+    bool m_congested = false;
+    std::chrono::steady_clock::time_point m_congested_since;
+    size_t m_congested_bytes = 0;
+    std::chrono::steady_clock::time_point m_next_present;
+    Scheduler m_scheduler;
+    TimerWheel m_timers;
+
+    struct FdWatch {
+        int fd;
+        std::function<void()> callback;
+    };
+    std::vector<FdWatch> m_fd_watches;
+    std::vector<pollfd> m_pollfds;
+
+    // Frame starts of the current stats window
+    struct FrameWindow {
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point last;
+        int intervals = 0;
+        double interval_sum = 0;
+        double interval_squares = 0;
+        double max_late = 0;
+    };
+    FrameWindow m_frame_window;
 };
 
 }  // namespace TUIE
\ No newline at end of file
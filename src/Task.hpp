@@ -0,0 +1,80 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+namespace TUIE {
+
+// Allocator of coroutine frames: free lists of GRANULE sized classes, so starting and finishing tasks does not go to
+// malloc once the pool is warm. The lists are per thread, a frame is freed by the thread that runs the scheduler.
+class FramePool {
+   public:
+    static constexpr size_t GRANULE = 64;
+    static constexpr size_t MAX_SIZE = 4096;
+
+    static void* allocate(size_t size);
+    static void deallocate(void* pointer, size_t size);
+};
+
+// Coroutine of the engine scheduler. A task is started with engine::spawn, or awaited by another task, which resumes
+// once it finishes. Exceptions propagate to the awaiting task, or out of engine::run for spawned ones.
+class Task {
+   public:
+    struct promise_type {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+            void await_resume() const noexcept {}
+        };
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        // Tasks start on the next frame of the scheduler, or right away when awaited
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() { exception = std::current_exception(); }
+
+        static void* operator new(size_t size) { return FramePool::allocate(size); }
+        static void operator delete(void* pointer, size_t size) { FramePool::deallocate(pointer, size); }
+    };
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (m_handle) m_handle.destroy();
+    }
+
+   public:
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+    void await_resume() const {
+        if (m_handle.promise().exception) {
+            std::rethrow_exception(m_handle.promise().exception);
+        }
+    }
+    // Hands the coroutine over to the scheduler
+    handle_type release() { return std::exchange(m_handle, {}); }
+
+   private:
+    explicit Task(handle_type handle) : m_handle(handle) {}
+
+   private:
+    handle_type m_handle;
+};
+
+}  // namespace TUIE
@@ -1,29 +1,67 @@
 #include "Terminal.hpp"
 
+#include <fcntl.h>
 #include <sys/ioctl.h>
+#include <unistd.h>
 
+#include <atomic>
 #include <csignal>
 
-#include "FixedOStream.hpp"
-#include "TUIengine.hpp"
+#include "Capabilities.hpp"
 
 namespace TUIE {
-void handle_sigwinch(int) { engine::instance().on_resize(); }
 
-Terminal::Terminal() : size(get_terminal_size()) {
-    std::signal(SIGWINCH, handle_sigwinch);
+namespace {
+
+std::atomic<uint32_t> g_resize_generation{0};
+
+void handle_sigwinch(int) { g_resize_generation.fetch_add(1, std::memory_order_relaxed); }
+
+}  // namespace
+
+OutputFd::OutputFd(int fd) : m_fd(fd) {
+    if (fd != STDOUT_FILENO || !isatty(fd)) return;
+    char path[256];
+    if (ttyname_r(fd, path, sizeof(path)) != 0) return;
+    const int reopened = open(path, O_WRONLY | O_NOCTTY | O_CLOEXEC);
+    if (reopened >= 0) {
+        m_fd = reopened;
+        m_owned = true;
+    }
+}
+
+OutputFd::~OutputFd() {
+    if (m_owned) {
+        close(m_fd);
+    }
+}
+
+uint32_t Terminal::get_resize_generation() { return g_resize_generation.load(std::memory_order_relaxed); }
+
+Terminal::Terminal(int input_fd, int output_fd, std::ostream& out, const Capabilities& capabilities)
+    : m_input_fd(input_fd), m_output_fd(output_fd), m_out(out), m_handles_sigwinch(input_fd == STDIN_FILENO) {
+    size = get_terminal_size();
+    if (m_handles_sigwinch) {
+        std::signal(SIGWINCH, handle_sigwinch);
+    }
     enable_raw_mode();
+    enable_nonblocking_output();
     enable_cursor(false);
-    enable_mouse(true);
-    enable_mouse_move(true);
-    enable_bracketed_paste(true);
+    apply_capabilities(capabilities);
     enable_line_wrapping(false);
     enter_fullscreen();
-    fixedCout.flush();
+    m_out.flush();
 }
 
 Terminal::~Terminal() {
-    std::signal(SIGWINCH, SIG_DFL);
+    if (m_handles_sigwinch) {
+        std::signal(SIGWINCH, SIG_DFL);
+    }
+    // Blocking again, so the restore sequences and any frame still queued reach the terminal
+    disable_nonblocking_output();
+    while (m_pushed_keyboard_flags > 0) {
+        pop_keyboard_flags();
+    }
     exit_fullscreen();
     enable_line_wrapping(true);
     enable_cursor(true);
@@ -34,11 +72,25 @@ Terminal::~Terminal() {
     reset_cursor();
     reset_colors();
     clear_screen();
-    fixedCout.flush();
+    m_out.flush();
+}
+
+void Terminal::apply_capabilities(const Capabilities& capabilities) {
+    if (capabilities.sgr_mouse != m_mouse_enabled) {
+        m_mouse_enabled = capabilities.sgr_mouse;
+        enable_mouse(m_mouse_enabled);
+        enable_mouse_move(m_mouse_enabled);
+    }
+    if (capabilities.bracketed_paste != m_bracketed_paste_enabled) {
+        m_bracketed_paste_enabled = capabilities.bracketed_paste;
+        enable_bracketed_paste(m_bracketed_paste_enabled);
+    }
 }
 
 void Terminal::enable_raw_mode() {
-    tcgetattr(STDIN_FILENO, &original_termios);
+    // Not every fd is a terminal (pipes, sockets), those have no modes to change
+    if (tcgetattr(m_input_fd, &original_termios) != 0) return;
+    m_raw_mode = true;
     struct termios raw = original_termios;
 
     // Disable ECHO: don't show what you type
@@ -52,48 +104,76 @@ void Terminal::enable_raw_mode() {
     raw.c_cc[VMIN] = 0;   // Read 0 or more bytes
     raw.c_cc[VTIME] = 1;  // Wait maximum 100ms (0.1s)
 
-    tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+    tcsetattr(m_input_fd, TCSAFLUSH, &raw);
+}
+
+void Terminal::enable_nonblocking_output() {
+    if (m_output_fd == STDOUT_FILENO) return;
+    m_output_flags = fcntl(m_output_fd, F_GETFL);
+    if (m_output_flags >= 0 && !(m_output_flags & O_NONBLOCK)) {
+        fcntl(m_output_fd, F_SETFL, m_output_flags | O_NONBLOCK);
+    }
 }
 
-void Terminal::disable_raw_mode() { tcsetattr(STDIN_FILENO, TCSAFLUSH, &original_termios); }
+void Terminal::disable_nonblocking_output() {
+    // The flags belong to the open file, which the caller can share, so they are put back as they were
+    if (m_output_flags >= 0) {
+        fcntl(m_output_fd, F_SETFL, m_output_flags);
+    }
+}
+
+void Terminal::disable_raw_mode() {
+    if (m_raw_mode) {
+        tcsetattr(m_input_fd, TCSAFLUSH, &original_termios);
+    }
+}
 
 void Terminal::on_resize() { size = get_terminal_size(); }
 
 TerminalSize Terminal::get_terminal_size() {
     winsize w;
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
+    if (ioctl(m_output_fd, TIOCGWINSZ, &w) != 0 || w.ws_col == 0 || w.ws_row == 0) {
+        // Without a window size, fall back to the classic terminal size
+        return {80, 24};
+    }
     return {w.ws_col, w.ws_row};
 }
 
-void Terminal::enter_fullscreen() { fixedCout << "\033[?1049h"; }
-void Terminal::exit_fullscreen() { fixedCout << "\033[?1049l"; }
-void Terminal::enable_line_wrapping(bool enable) { fixedCout << (enable ? "\033[?7h" : "\033[?7l"); }
-void Terminal::enable_cursor(bool enable) { fixedCout << (enable ? "\033[?25h" : "\033[?25l"); }
+void Terminal::enter_fullscreen() { m_out << "\033[?1049h"; }
+void Terminal::exit_fullscreen() { m_out << "\033[?1049l"; }
+void Terminal::enable_line_wrapping(bool enable) { m_out << (enable ? "\033[?7h" : "\033[?7l"); }
+void Terminal::enable_cursor(bool enable) { m_out << (enable ? "\033[?25h" : "\033[?25l"); }
 void Terminal::enable_mouse(bool enable) {
-    fixedCout << (enable ? "\033[?1000h\033[?1006h" : "\033[?1000l\033[?1006l");
+    m_out << (enable ? "\033[?1000h\033[?1006h" : "\033[?1000l\033[?1006l");
 }
-void Terminal::enable_bracketed_paste(bool enable) { fixedCout << (enable ? "\033[?2004h" : "\033[?2004l"); }
-void Terminal::enable_mouse_move(bool enable) { fixedCout << (enable ? "\033[?1003h" : "\033[?1003l"); }
-
-void Terminal::clear_screen() { fixedCout << "\033[2J"; }
-void Terminal::reset_cursor() { fixedCout << "\033[H"; }
-void Terminal::reset_colors() { fixedCout << "\033[0m"; }
-void Terminal::reset_foreground() { fixedCout << "\033[39m"; }
-void Terminal::reset_background() { fixedCout << "\033[49m"; }
-void Terminal::set_cursor_position(int x, int y) { fixedCout << "\033[" << y << ";" << x << "H"; }
-void Terminal::set_background_color(Color color) {
-    if (color.without_color) {
-        reset_background();
-    } else {
-        fixedCout << "\033[48;2;" << (int)color.r << ";" << (int)color.g << ";" << (int)color.b << "m";
+void Terminal::enable_bracketed_paste(bool enable) { m_out << (enable ? "\033[?2004h" : "\033[?2004l"); }
+void Terminal::enable_mouse_move(bool enable) { m_out << (enable ? "\033[?1003h" : "\033[?1003l"); }
+
+void Terminal::request_mode(int mode) { m_out << "\033[?" << mode << "$p"; }
+void Terminal::request_keyboard_flags() { m_out << "\033[?u"; }
+void Terminal::request_device_attributes() { m_out << "\033[c"; }
+void Terminal::request_capability(std::string_view name) {
+    static constexpr char HEX[] = "0123456789ABCDEF";
+    m_out << "\033P+q";
+    for (const char c : name) {
+        m_out << HEX[static_cast<unsigned char>(c) >> 4] << HEX[c & 0xF];
     }
+    m_out << "\033\\";
 }
-void Terminal::set_foreground_color(Color color) {
-    if (color.without_color) {
-        reset_foreground();
-    } else {
-        fixedCout << "\033[38;2;" << (int)color.r << ";" << (int)color.g << ";" << (int)color.b << "m";
-    }
+void Terminal::push_keyboard_flags(int flags) {
+    m_out << "\033[>" << flags << "u";
+    m_pushed_keyboard_flags++;
+}
+void Terminal::pop_keyboard_flags() {
+    if (m_pushed_keyboard_flags == 0) return;
+    m_out << "\033[<u";
+    m_pushed_keyboard_flags--;
 }
+void Terminal::begin_synchronized_update() { m_out << "\033[?2026h"; }
+void Terminal::end_synchronized_update() { m_out << "\033[?2026l"; }
+
+void Terminal::clear_screen() { m_out << "\033[2J"; }
+void Terminal::reset_cursor() { m_out << "\033[H"; }
+void Terminal::reset_colors() { m_out << "\033[0m"; }
 
 }  // namespace TUIE
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 #include <termios.h>
 
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
 #include "Color.hpp"
 
 namespace TUIE {
@@ -11,18 +15,57 @@ struct TerminalSize {
     int height;
 };
 
+// The fd an engine writes its frames to. O_NONBLOCK belongs to the open file, which stdout shares with stderr and the
+// shell, so the terminal of the process is opened again and only that copy is made non-blocking: a process that dies
+// without its destructors leaves the shell with the terminal as it was. Other fds belong to their caller and are used
+// as they are.
+class OutputFd {
+   public:
+    explicit OutputFd(int fd);
+    ~OutputFd();
+    OutputFd(const OutputFd&) = delete;
+    OutputFd& operator=(const OutputFd&) = delete;
+
+    int get() const { return m_fd; }
+
+   private:
+    int m_fd;
+    bool m_owned = false;
+};
+
+struct Capabilities;
+
+// DEC private mode of the synchronized updates
+inline constexpr int SYNCHRONIZED_OUTPUT_MODE = 2026;
+// Kitty keyboard flags: disambiguate the escape codes (1), report the event types (2), report every key as an escape
+// code (8) and the text it types (16)
+inline constexpr int KITTY_KEYBOARD_FLAGS = 1 | 2 | 8 | 16;
+
+// Terminal modes of one terminal, reached through an fd pair. Only the terminal bound to stdin handles SIGWINCH, the
+// others (ptys served by one process) are told about resizes by their owner through engine::on_resize.
 class Terminal {
    public:
-    Terminal();
+    // Only the modes the capabilities have are enabled
+    Terminal(int input_fd, int output_fd, std::ostream& out, const Capabilities& capabilities);
     ~Terminal();
+    Terminal(const Terminal&) = delete;
+    Terminal& operator=(const Terminal&) = delete;
 
    public:
     void on_resize();
     TerminalSize get_terminal_size();
+    // Incremented by the SIGWINCH handler, it is only an atomic counter so the handler stays async-signal-safe
+    static uint32_t get_resize_generation();
+    // Enables or disables the modes that depend on the capabilities, called again when the probe changes them
+    void apply_capabilities(const Capabilities& capabilities);
 
    private:
     void enable_raw_mode();
     void disable_raw_mode();
+    // The output is written without blocking, so a slow terminal makes the engine skip frames instead of stalling it.
+    // A stdout that could not be opened again (see OutputFd) stays blocking.
+    void enable_nonblocking_output();
+    void disable_nonblocking_output();
     void enter_fullscreen();
     void exit_fullscreen();
 
@@ -33,20 +76,36 @@ class Terminal {
     void enable_bracketed_paste(bool enable);
     void enable_mouse_move(bool enable);
 
+    // Asks the terminal whether it knows a DEC private mode, the reply arrives as input (Input::get_reports)
+    void request_mode(int mode);
+    // The kitty keyboard flags (CSI ? u), the primary device attributes (DA1) and a terminfo capability (XTGETTCAP)
+    void request_keyboard_flags();
+    void request_device_attributes();
+    void request_capability(std::string_view name);
+    // Enters the kitty keyboard protocol with the flags, the previous mode is restored by pop or on destruction
+    void push_keyboard_flags(int flags);
+    void pop_keyboard_flags();
+    // Frames between begin and end are shown at once, so a frame written over several writes does not tear
+    void begin_synchronized_update();
+    void end_synchronized_update();
+
     void clear_screen();
     void reset_cursor();
     void reset_colors();
-    void reset_foreground();
-    void reset_background();
-
-    void set_cursor_position(int x, int y);
-    void set_background_color(Color color);
-    void set_foreground_color(Color color);
 
    public:
     TerminalSize size;
 
    private:
+    int m_input_fd;
+    int m_output_fd;
+    std::ostream& m_out;
+    bool m_handles_sigwinch;
+    bool m_raw_mode = false;
+    bool m_mouse_enabled = false;
+    bool m_bracketed_paste_enabled = false;
+    int m_output_flags = -1;
+    int m_pushed_keyboard_flags = 0;
     termios original_termios;
 };
 
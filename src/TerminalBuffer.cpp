@@ -1,5 +1,8 @@
 #include "TerminalBuffer.hpp"
 
+#include <algorithm>
+#include <type_traits>
+
 namespace TUIE {
 
 TerminalBuffer::TerminalBuffer(int width, int height) : width(width), height(height), buffer(width * height) {}
@@ -22,7 +25,7 @@ TerminalCell TerminalBuffer::get_cell(int x, int y) const { return buffer[get_in
 
 void TerminalBuffer::set_cell(int x, int y, TerminalCell cell) { buffer[get_index(x, y)] = cell; }
 
-void TerminalBuffer::set_character(int x, int y, char character) { buffer[get_index(x, y)].character = character; }
+void TerminalBuffer::set_character(int x, int y, char32_t character) { buffer[get_index(x, y)].character = character; }
 
 void TerminalBuffer::set_foreground_color(int x, int y, Color color) {
     buffer[get_index(x, y)].foreground_color = color;
@@ -32,6 +35,71 @@ void TerminalBuffer::set_background_color(int x, int y, Color color) {
     buffer[get_index(x, y)].background_color = color;
 }
 
+bool TerminalBuffer::clip(const TerminalBuffer& source, Rect& source_rect, int& x, int& y) const {
+    // Clip the source rect to the source buffer, moving the destination along with it
+    if (source_rect.x < 0) {
+        x -= source_rect.x;
+        source_rect.width += source_rect.x;
+        source_rect.x = 0;
+    }
+    if (source_rect.y < 0) {
+        y -= source_rect.y;
+        source_rect.height += source_rect.y;
+        source_rect.y = 0;
+    }
+    source_rect.width = std::min(source_rect.width, source.width - source_rect.x);
+    source_rect.height = std::min(source_rect.height, source.height - source_rect.y);
+    // Then clip the destination to this buffer
+    if (x < 0) {
+        source_rect.x -= x;
+        source_rect.width += x;
+        x = 0;
+    }
+    if (y < 0) {
+        source_rect.y -= y;
+        source_rect.height += y;
+        y = 0;
+    }
+    source_rect.width = std::min(source_rect.width, width - x);
+    source_rect.height = std::min(source_rect.height, height - y);
+    return !source_rect.empty();
+}
+
+void TerminalBuffer::copy_from(const TerminalBuffer& source, Rect source_rect, int x, int y) {
+    if (!clip(source, source_rect, x, y)) return;
+
+    // The cells are trivially copyable, so every row is a single memmove
+    static_assert(std::is_trivially_copyable_v<TerminalCell>);
+    for (int i = 0; i < source_rect.height; i++) {
+        const auto from = source.buffer.begin() + (source_rect.y + i) * source.width + source_rect.x;
+        std::copy_n(from, source_rect.width, buffer.begin() + (y + i) * width + x);
+    }
+}
+
+void TerminalBuffer::blit(const TerminalBuffer& source, Rect source_rect, int x, int y, BlitMode mode, Color key) {
+    if (mode == BlitMode::OPAQUE) {
+        copy_from(source, source_rect, x, y);
+        return;
+    }
+    if (!clip(source, source_rect, x, y)) return;
+
+    // Select per cell without branching on the content, so the row loops stay simple for the compiler
+    for (int i = 0; i < source_rect.height; i++) {
+        const TerminalCell* from = source.buffer.data() + (source_rect.y + i) * source.width + source_rect.x;
+        TerminalCell* to = buffer.data() + (y + i) * width + x;
+        if (mode == BlitMode::TRANSPARENT) {
+            for (int j = 0; j < source_rect.width; j++) {
+                to[j] = from[j].background_color == key ? to[j] : from[j];
+            }
+        } else {
+            for (int j = 0; j < source_rect.width; j++) {
+                const Color background = from[j].background_color;
+                to[j].background_color = background == key ? to[j].background_color : background;
+            }
+        }
+    }
+}
+
 inline int TerminalBuffer::get_index(int x, int y) const {
     if (x < 0 || x >= width || y < 0 || y >= height) {
         throw std::out_of_range("x or y is out of bounds");
@@ -59,7 +127,7 @@ std::ostream& operator<<(std::ostream& os, const TerminalBuffer& buffer) {
     for (int i = 0; i < buffer.height; i++) {
         os << "│";
         for (int j = 0; j < buffer.width; j++) {
-            os << buffer.get_cell(j, i).character;
+            write_utf8(os, buffer.get_cell(j, i).character);
         }
         os << "│";
         os << '\n';
@@ -1,13 +1,16 @@
 #pragma once
 
+#include <span>
 #include <vector>
 
 #include "Color.hpp"
+#include "Rect.hpp"
+#include "Utf8.hpp"
 
 namespace TUIE {
 
 struct TerminalCell {
-    char character = ' ';
+    char32_t character = U' ';
     Color foreground_color = TERMINAL_COLOR;
     Color background_color = TERMINAL_COLOR;
 
@@ -19,11 +22,22 @@ struct TerminalCell {
     bool operator!=(const TerminalCell& other) const { return !(*this == other); }
 
     friend std::ostream& operator<<(std::ostream& os, const TerminalCell& cell) {
-        os << "['" << cell.character << "', " << cell.foreground_color << ", " << cell.background_color << "]";
+        os << "['";
+        write_utf8(os, cell.character);
+        os << "', " << cell.foreground_color << ", " << cell.background_color << "]";
         return os;
     }
 };
 
+enum class BlitMode {
+    // Every cell is copied
+    OPAQUE,
+    // Cells whose background is the key color are skipped, so sprites can have any shape
+    TRANSPARENT,
+    // Only the background of the cells that are not the key color, the text below stays
+    BACKGROUND,
+};
+
 class TerminalBuffer {
    public:
     TerminalBuffer(int width, int height);
@@ -31,18 +45,26 @@ class TerminalBuffer {
     void resize(int width, int height, TerminalCell fill = {});
     TerminalCell get_cell(int x, int y) const;
     void set_cell(int x, int y, TerminalCell cell);
-    void set_character(int x, int y, char character);
+    void set_character(int x, int y, char32_t character);
     void set_foreground_color(int x, int y, Color color);
     void set_background_color(int x, int y, Color color);
+    // Copies the source_rect of source to x, y row by row, clipped to both buffers
+    void copy_from(const TerminalBuffer& source, Rect source_rect, int x, int y);
+    void blit(const TerminalBuffer& source, Rect source_rect, int x, int y, BlitMode mode,
+              Color key = TERMINAL_COLOR);
 
    private:
     inline int get_index(int x, int y) const;
     inline int get_index(int x, int y, int width, int height) const;
+    bool clip(const TerminalBuffer& source, Rect& source_rect, int& x, int& y) const;
 
    public:
     int get_width() const { return width; }
     int get_height() const { return height; }
     bool is_inside(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+    // Row-major view of all the cells, for code that walks the whole buffer (encoding, bulk copies)
+    std::span<const TerminalCell> cells() const { return buffer; }
+    std::span<TerminalCell> cells() { return buffer; }
 
    private:
     std::vector<TerminalCell> buffer;
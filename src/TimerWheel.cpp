@@ -0,0 +1,184 @@
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace TUIE {
+
+TimerWheel::TimerWheel(std::chrono::nanoseconds tick, Clock::time_point start)
+    : m_tick(std::chrono::duration_cast<Clock::duration>(tick)), m_start(start) {
+    std::fill(std::begin(m_slots), std::end(m_slots), NONE);
+}
+
+uint64_t TimerWheel::to_tick(Clock::time_point time) const {
+    if (time <= m_start) return 0;
+    // Rounded up, so a timer never runs before its deadline
+    return ((time - m_start) + m_tick - Clock::duration(1)) / m_tick;
+}
+
+TimerWheel::Clock::time_point TimerWheel::to_time(uint64_t tick) const { return m_start + tick * m_tick; }
+
+TimerWheel::TimerId TimerWheel::schedule_at(Clock::time_point deadline, Clock::duration interval, Callback callback) {
+    int32_t index;
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+    } else {
+        index = static_cast<int32_t>(m_timers.size());
+        m_timers.emplace_back();
+    }
+    Timer& timer = m_timers[index];
+    timer.expiry = std::max(to_tick(deadline), m_current + 1);
+    timer.interval = interval.count() > 0 ? std::max<uint64_t>((interval + m_tick - Clock::duration(1)) / m_tick, 1) : 0;
+    timer.callback = std::move(callback);
+    insert(index);
+    m_size++;
+    return static_cast<uint64_t>(timer.generation) << 32 | static_cast<uint32_t>(index);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    const int32_t index = static_cast<int32_t>(id & 0xFFFFFFFF);
+    if (index < 0 || index >= static_cast<int32_t>(m_timers.size())) return false;
+    Timer& timer = m_timers[index];
+    if (timer.generation != id >> 32) return false;
+    if (index == m_running) {
+        // Cancelled from its own callback, it is released once the callback returns
+        timer.interval = 0;
+        return true;
+    }
+    if (timer.slot == NONE) return false;
+    unlink(index);
+    release(index);
+    return true;
+}
+
+void TimerWheel::insert(int32_t index) {
+    Timer& timer = m_timers[index];
+    // The level is the one of the highest bits in which the expiry differs from the current tick
+    int level = 0;
+    while (level < LEVELS && (timer.expiry >> (SLOT_BITS * (level + 1))) != (m_current >> (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    int32_t slot = LEVELS * SLOTS;
+    if (level < LEVELS) {
+        const int position = (timer.expiry >> (SLOT_BITS * level)) & (SLOTS - 1);
+        slot = level * SLOTS + position;
+        m_occupied[level] |= uint64_t(1) << position;
+    }
+    timer.slot = slot;
+    timer.previous = NONE;
+    timer.next = m_slots[slot];
+    if (timer.next != NONE) m_timers[timer.next].previous = index;
+    m_slots[slot] = index;
+}
+
+void TimerWheel::unlink(int32_t index) {
+    Timer& timer = m_timers[index];
+    if (timer.previous != NONE) {
+        m_timers[timer.previous].next = timer.next;
+    } else {
+        m_slots[timer.slot] = timer.next;
+    }
+    if (timer.next != NONE) m_timers[timer.next].previous = timer.previous;
+    if (m_slots[timer.slot] == NONE && timer.slot < LEVELS * SLOTS) {
+        m_occupied[timer.slot / SLOTS] &= ~(uint64_t(1) << (timer.slot % SLOTS));
+    }
+    timer.slot = NONE;
+}
+
+void TimerWheel::release(int32_t index) {
+    Timer& timer = m_timers[index];
+    timer.callback = nullptr;
+    timer.generation++;
+    m_free.push_back(index);
+    m_size--;
+}
+
+// Moves the timers of the current slot of the level (or of the overflow list) down, they only differ from the
+// current tick in the lower levels now
+void TimerWheel::cascade(int level) {
+    const int32_t slot =
+        level < LEVELS ? level * SLOTS + ((m_current >> (SLOT_BITS * level)) & (SLOTS - 1)) : LEVELS * SLOTS;
+    int32_t index = m_slots[slot];
+    while (index != NONE) {
+        const int32_t next = m_timers[index].next;
+        unlink(index);
+        insert(index);
+        index = next;
+    }
+}
+
+void TimerWheel::run_slot(int slot, uint64_t target) {
+    while (m_slots[slot] != NONE) {
+        const int32_t index = m_slots[slot];
+        unlink(index);
+        // The callback can schedule timers, which can move the storage, so it is moved out while it runs
+        Callback callback = std::move(m_timers[index].callback);
+        m_running = index;
+        callback();
+        m_running = NONE;
+
+        Timer& timer = m_timers[index];
+        if (timer.interval > 0) {
+            // Runs once for the periods missed by a late advance, the next one keeps the phase of the first deadline
+            timer.expiry += timer.interval;
+            if (timer.expiry <= target) {
+                timer.expiry += (target - timer.expiry) / timer.interval * timer.interval + timer.interval;
+            }
+            timer.callback = std::move(callback);
+            insert(index);
+        } else {
+            release(index);
+        }
+    }
+}
+
+void TimerWheel::advance(Clock::time_point now) {
+    // Rounded down, only the ticks that fully passed
+    const uint64_t target = now <= m_start ? 0 : (now - m_start) / m_tick;
+    while (m_current < target) {
+        if (m_size == 0) {
+            m_current = target;
+            break;
+        }
+        if (m_occupied[0] == 0) {
+            // Nothing on the lowest level, skip to the tick before it wraps and the next slot of level 1 comes down
+            const uint64_t before_wrap = m_current | (SLOTS - 1);
+            if (before_wrap >= target) {
+                m_current = target;
+                break;
+            }
+            m_current = before_wrap;
+        }
+        m_current++;
+
+        int wrapped = 0;
+        while (wrapped < LEVELS && (m_current & ((uint64_t(1) << (SLOT_BITS * (wrapped + 1))) - 1)) == 0) {
+            wrapped++;
+        }
+        for (int level = wrapped; level >= 1; level--) {
+            cascade(level);
+        }
+        run_slot(m_current & (SLOTS - 1), target);
+    }
+}
+
+TimerWheel::Clock::time_point TimerWheel::next_deadline() const {
+    if (m_size == 0) return Clock::time_point::max();
+    for (int level = 0; level < LEVELS; level++) {
+        const int position = (m_current >> (SLOT_BITS * level)) & (SLOTS - 1);
+        if (position == SLOTS - 1) continue;
+        const uint64_t later = m_occupied[level] & (~uint64_t(0) << (position + 1));
+        if (later == 0) continue;
+        // The start of the slot, the timers in it are due at or after it
+        const int shift = SLOT_BITS * (level + 1);
+        const uint64_t base = m_current >> shift << shift;
+        const uint64_t tick = base + (static_cast<uint64_t>(std::countr_zero(later)) << (SLOT_BITS * level));
+        return to_time(std::max(tick, m_current + 1));
+    }
+    // Only the timers beyond the last level are left, they come down when it wraps
+    const int shift = SLOT_BITS * LEVELS;
+    return to_time(((m_current >> shift) + 1) << shift);
+}
+
+}  // namespace TUIE
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace TUIE {
+
+// Timers on a hierarchical timing wheel: 4 levels of 64 slots, a timer goes into the level of the highest bits in
+// which its expiry differs from the current tick and moves down a level every time the lower level wraps. Scheduling
+// and cancelling are O(1) whatever the number of timers, and advancing only looks at the slots that are due.
+//
+// The callbacks run from advance, on the thread that owns the wheel. They can schedule and cancel timers.
+class TimerWheel {
+   public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    // Generation and index of the timer, an id stays invalid after its timer ran or was cancelled
+    using TimerId = uint64_t;
+
+    explicit TimerWheel(std::chrono::nanoseconds tick = std::chrono::milliseconds(1),
+                        Clock::time_point start = Clock::now());
+
+   public:
+    TimerId schedule(Clock::duration delay, Callback callback) {
+        return schedule_at(Clock::now() + delay, {}, std::move(callback));
+    }
+    // Runs every interval, measured from the first deadline so the timer does not drift. When advance is late by several
+    // intervals it runs once for all of them.
+    TimerId schedule_every(Clock::duration interval, Callback callback) {
+        return schedule_at(Clock::now() + interval, interval, std::move(callback));
+    }
+    TimerId schedule_at(Clock::time_point deadline, Clock::duration interval, Callback callback);
+    // False when the timer already ran (or was cancelled)
+    bool cancel(TimerId id);
+    // Runs the timers due up to now
+    void advance(Clock::time_point now = Clock::now());
+    // When the next timer is due, Clock::time_point::max() without timers. It can be earlier than the real deadline of
+    // a timer in the upper levels, advancing then only moves timers down.
+    Clock::time_point next_deadline() const;
+    size_t size() const { return m_size; }
+
+   private:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr int32_t NONE = -1;
+
+    struct Timer {
+        int32_t previous = NONE;
+        int32_t next = NONE;
+        int32_t slot = NONE;
+        uint32_t generation = 0;
+        uint64_t expiry = 0;
+        uint64_t interval = 0;
+        Callback callback;
+    };
+
+    void insert(int32_t index);
+    void unlink(int32_t index);
+    void release(int32_t index);
+    void cascade(int level);
+    void run_slot(int slot, uint64_t target);
+    uint64_t to_tick(Clock::time_point time) const;
+    Clock::time_point to_time(uint64_t tick) const;
+
+   private:
+    Clock::duration m_tick;
+    Clock::time_point m_start;
+    uint64_t m_current = 0;
+    size_t m_size = 0;
+    std::vector<Timer> m_timers;
+    std::vector<int32_t> m_free;
+    // The slots of every level, then one for the timers beyond the last level
+    int32_t m_slots[LEVELS * SLOTS + 1];
+    int32_t m_running = NONE;
+    uint64_t m_occupied[LEVELS] = {};
+};
+
+}  // namespace TUIE
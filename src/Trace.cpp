@@ -0,0 +1,99 @@
+#include "Trace.hpp"
+
+#ifdef TRACE
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+namespace TUIE {
+
+Tracer& Tracer::instance() {
+    static Tracer* instance = new Tracer();
+    return *instance;
+}
+
+int64_t Tracer::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+Tracer::Tracer() {
+    const char* path = std::getenv("TUIE_TRACE");
+    m_file = std::fopen(path ? path : "trace.json", "w");
+    if (m_file) {
+        std::fputs("[\n", m_file);
+    }
+    m_thread = std::jthread([this](std::stop_token stop) { run(stop); });
+    std::atexit([]() { instance().finish(); });
+}
+
+TraceRing* Tracer::register_thread() {
+    std::lock_guard lock(m_rings_mutex);
+    m_rings.push_back(std::make_unique<TraceRing>(static_cast<uint32_t>(m_rings.size() + 1)));
+    return m_rings.back().get();
+}
+
+void Tracer::run(std::stop_token stop) {
+    while (!stop.stop_requested()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        write_events();
+    }
+}
+
+void Tracer::write_events() {
+    {
+        std::lock_guard lock(m_rings_mutex);
+        m_draining.clear();
+        for (const auto& ring : m_rings) {
+            m_draining.push_back(ring.get());
+        }
+    }
+    if (!m_file) return;
+    const int pid = getpid();
+    for (TraceRing* ring : m_draining) {
+        ring->drain([&](const TraceEvent& event) {
+            // Timestamps are in microseconds, the fraction keeps the nanoseconds
+            std::fprintf(m_file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRId64 ".%03d,\"pid\":%d,\"tid\":%" PRIu32,
+                         m_first_event ? "" : ",\n", event.name, event.phase, event.timestamp_ns / 1000,
+                         static_cast<int>(event.timestamp_ns % 1000), pid, ring->get_thread_id());
+            if (event.phase == 'C') {
+                std::fprintf(m_file, ",\"args\":{\"value\":%" PRId64 "}}", event.value);
+            } else if (event.phase == 'i') {
+                std::fputs(",\"s\":\"t\"}", m_file);
+            } else {
+                std::fputc('}', m_file);
+            }
+            m_first_event = false;
+        });
+    }
+    std::fflush(m_file);
+}
+
+void Tracer::finish() {
+    m_thread.request_stop();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    write_events();
+    if (m_file) {
+        for (TraceRing* ring : m_draining) {
+            if (ring->get_dropped() > 0) {
+                std::fprintf(m_file, "%s{\"name\":\"dropped events\",\"ph\":\"C\",\"ts\":0,\"pid\":%d,\"tid\":%" PRIu32
+                             ",\"args\":{\"value\":%" PRIu64 "}}",
+                             m_first_event ? "" : ",\n", getpid(), ring->get_thread_id(), ring->get_dropped());
+                m_first_event = false;
+            }
+        }
+        std::fputs("\n]\n", m_file);
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+}  // namespace TUIE
+
+#endif
@@ -0,0 +1,119 @@
+#pragma once
+
+// Scoped trace events for frame timelines. Built with -DTRACE (see CMakeLists.txt) the events are recorded into
+// per-thread rings and a background thread writes them as Chrome trace events to trace.json, or to the file named by
+// the TUIE_TRACE environment variable, which opens in Perfetto (ui.perfetto.dev) or chrome://tracing. Without TRACE
+// the macros compile to nothing. Event names must be string literals, only their pointer is recorded.
+
+#ifdef TRACE
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TUIE {
+
+struct TraceEvent {
+    const char* name;
+    int64_t timestamp_ns;
+    int64_t value;
+    char phase;
+};
+
+// Events of one thread, pushed only by that thread and drained only by the tracer thread, so it needs no lock. When
+// the tracer falls behind the new events are dropped and counted.
+class TraceRing {
+   public:
+    static constexpr size_t CAPACITY = 1 << 16;
+
+    explicit TraceRing(uint32_t thread_id) : m_events(new TraceEvent[CAPACITY]), m_thread_id(thread_id) {}
+
+   public:
+    void push(const TraceEvent& event) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == CAPACITY) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        m_events[head & (CAPACITY - 1)] = event;
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    template <typename Consumer>
+    void drain(Consumer&& consume) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        for (size_t i = tail; i != head; i++) {
+            consume(m_events[i & (CAPACITY - 1)]);
+        }
+        m_tail.store(head, std::memory_order_release);
+    }
+
+    uint32_t get_thread_id() const { return m_thread_id; }
+    uint64_t get_dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+   private:
+    std::unique_ptr<TraceEvent[]> m_events;
+    alignas(64) std::atomic<size_t> m_head = 0;
+    alignas(64) std::atomic<size_t> m_tail = 0;
+    std::atomic<uint64_t> m_dropped = 0;
+    uint32_t m_thread_id;
+};
+
+class Tracer {
+   public:
+    // Never destroyed, threads can still trace while the process exits. The file is finished by an atexit handler.
+    static Tracer& instance();
+
+    static void record(const char* name, char phase, int64_t value = 0) {
+        thread_local TraceRing* ring = instance().register_thread();
+        ring->push({name, now_ns(), value, phase});
+    }
+    static int64_t now_ns();
+
+   private:
+    Tracer();
+    TraceRing* register_thread();
+    void run(std::stop_token stop);
+    void write_events();
+    void finish();
+
+   private:
+    std::mutex m_rings_mutex;
+    std::vector<std::unique_ptr<TraceRing>> m_rings;
+    std::vector<TraceRing*> m_draining;
+    std::FILE* m_file = nullptr;
+    bool m_first_event = true;
+    std::jthread m_thread;
+};
+
+class TraceScope {
+   public:
+    explicit TraceScope(const char* name) : m_name(name) { Tracer::record(name, 'B'); }
+    ~TraceScope() { Tracer::record(m_name, 'E'); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+   private:
+    const char* m_name;
+};
+
+}  // namespace TUIE
+
+#define __trace_name2(line)        _trace_scope_line_##line
+#define __trace_name(line)         __trace_name2(line)
+#define TRACE_SCOPE(name)          ::TUIE::TraceScope __trace_name(__LINE__)(name)
+#define TRACE_INSTANT(name)        ::TUIE::Tracer::record(name, 'i')
+#define TRACE_COUNTER(name, value) ::TUIE::Tracer::record(name, 'C', value)
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_INSTANT(name)
+#define TRACE_COUNTER(name, value)
+
+#endif
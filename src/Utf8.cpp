@@ -0,0 +1,97 @@
+#include "Utf8.hpp"
+
+namespace TUIE {
+
+char32_t pop_utf8(std::string_view& text) {
+    const unsigned char lead = text[0];
+    if (lead < 0x80) {
+        text.remove_prefix(1);
+        return lead;
+    }
+
+    int length;
+    char32_t code_point;
+    char32_t minimum;
+    if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        code_point = lead & 0x1F;
+        minimum = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        code_point = lead & 0x0F;
+        minimum = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        code_point = lead & 0x07;
+        minimum = 0x10000;
+    } else {
+        text.remove_prefix(1);
+        return REPLACEMENT_CHARACTER;
+    }
+    if (text.size() < static_cast<size_t>(length)) {
+        text.remove_prefix(1);
+        return REPLACEMENT_CHARACTER;
+    }
+    for (int i = 1; i < length; i++) {
+        const unsigned char byte = text[i];
+        if ((byte & 0xC0) != 0x80) {
+            text.remove_prefix(1);
+            return REPLACEMENT_CHARACTER;
+        }
+        code_point = code_point << 6 | (byte & 0x3F);
+    }
+    // Overlong encodings, surrogates and values past the last code point are not valid UTF-8
+    if (code_point < minimum || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+        text.remove_prefix(1);
+        return REPLACEMENT_CHARACTER;
+    }
+    text.remove_prefix(length);
+    return code_point;
+}
+
+void append_utf8(std::string& out, char32_t code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | code_point >> 6);
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | code_point >> 12);
+        out += static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | code_point >> 18);
+        out += static_cast<char>(0x80 | (code_point >> 12 & 0x3F));
+        out += static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+void write_utf8(std::ostream& out, char32_t code_point) {
+    if (code_point < 0x80) {
+        out.put(static_cast<char>(code_point));
+        return;
+    }
+    std::string bytes;
+    append_utf8(bytes, code_point);
+    out.write(bytes.data(), bytes.size());
+}
+
+size_t utf8_length(std::string_view text) {
+    size_t length = 0;
+    while (!text.empty()) {
+        pop_utf8(text);
+        length++;
+    }
+    return length;
+}
+
+std::string_view utf8_prefix(std::string_view text, size_t code_points) {
+    std::string_view rest = text;
+    for (size_t i = 0; i < code_points && !rest.empty(); i++) {
+        pop_utf8(rest);
+    }
+    return text.substr(0, text.size() - rest.size());
+}
+
+}  // namespace TUIE
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace TUIE {
+
+constexpr char32_t REPLACEMENT_CHARACTER = U'�';
+
+// Decodes the code point at the front of text and advances past it. Invalid or truncated sequences decode to
+// REPLACEMENT_CHARACTER consuming one byte, so any byte string can be drawn.
+char32_t pop_utf8(std::string_view& text);
+void append_utf8(std::string& out, char32_t code_point);
+void write_utf8(std::ostream& out, char32_t code_point);
+// Number of code points, which is the number of cells the text takes
+size_t utf8_length(std::string_view text);
+// The first code_points code points of text, the whole text when it is shorter. Cuts text to a number of cells
+// without splitting a sequence.
+std::string_view utf8_prefix(std::string_view text, size_t code_points);
+
+}  // namespace TUIE
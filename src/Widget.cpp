@@ -0,0 +1,222 @@
+#include "Widget.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+#include "TUIengine.hpp"
+#include "Utf8.hpp"
+
+namespace TUIE {
+
+Widget& Widget::set_fixed_size(int size) {
+    if (m_fixed_size != size) {
+        m_fixed_size = size;
+        invalidate_layout();
+    }
+    return *this;
+}
+
+Widget& Widget::set_flex(int flex) {
+    if (m_flex != flex) {
+        m_flex = flex;
+        invalidate_layout();
+    }
+    return *this;
+}
+
+Widget& Widget::set_border(bool border) {
+    if (m_border != border) {
+        m_border = border;
+        // The content area changes, so the children move too
+        m_needs_layout = true;
+        invalidate_paint();
+    }
+    return *this;
+}
+
+Widget& Widget::set_background(Color color) {
+    if (m_background != color) {
+        m_background = color;
+        invalidate_paint();
+    }
+    return *this;
+}
+
+Widget& Widget::set_foreground(Color color) {
+    if (m_foreground != color) {
+        m_foreground = color;
+        invalidate_paint();
+    }
+    return *this;
+}
+
+void Widget::mark_ancestors() {
+    // Once an ancestor is marked the ones above it are marked too
+    for (Widget* parent = m_parent; parent && !parent->m_child_dirty; parent = parent->m_parent) {
+        parent->m_child_dirty = true;
+    }
+}
+
+void Widget::invalidate_paint() {
+    m_needs_paint = true;
+    mark_ancestors();
+}
+
+void Widget::invalidate_layout() {
+    // The size of a node is decided by its parent, which repaints too since the space it leaves free changes
+    if (m_parent) {
+        m_parent->m_needs_layout = true;
+        m_parent->invalidate_paint();
+    }
+}
+
+Rect Widget::content_rect() const {
+    if (!m_border) return m_rect;
+    return {m_rect.x + 1, m_rect.y + 1, std::max(m_rect.width - 2, 0), std::max(m_rect.height - 2, 0)};
+}
+
+void Widget::set_rect(Rect rect) {
+    if (m_rect == rect) return;
+    m_rect = rect;
+    m_needs_layout = true;
+    invalidate_paint();
+}
+
+void Widget::paint(engine& engine) {
+    if (m_rect.empty()) return;
+    engine.draw_rect(m_rect.x, m_rect.y, m_rect.width, m_rect.height, m_background, ' ', m_foreground);
+    if (m_border) {
+        const int right = m_rect.x + m_rect.width - 1;
+        const int bottom = m_rect.y + m_rect.height - 1;
+        engine.draw_rect(m_rect.x, m_rect.y, m_rect.width, 1, m_background, U'─', m_foreground);
+        engine.draw_rect(m_rect.x, bottom, m_rect.width, 1, m_background, U'─', m_foreground);
+        engine.draw_rect(m_rect.x, m_rect.y, 1, m_rect.height, m_background, U'│', m_foreground);
+        engine.draw_rect(right, m_rect.y, 1, m_rect.height, m_background, U'│', m_foreground);
+        engine.draw_rect(m_rect.x, m_rect.y, 1, 1, m_background, U'┌', m_foreground);
+        engine.draw_rect(right, m_rect.y, 1, 1, m_background, U'┐', m_foreground);
+        engine.draw_rect(m_rect.x, bottom, 1, 1, m_background, U'└', m_foreground);
+        engine.draw_rect(right, bottom, 1, 1, m_background, U'┘', m_foreground);
+    }
+    paint_content(engine, content_rect());
+}
+
+void Widget::update(engine& engine) {
+    if (m_needs_layout) {
+        layout_children();
+        m_needs_layout = false;
+    }
+    const bool repaint = m_needs_paint;
+    if (repaint) {
+        paint(engine);
+        m_needs_paint = false;
+    }
+    if (!repaint && !m_child_dirty) return;
+    m_child_dirty = false;
+    if (auto* nodes = children()) {
+        for (auto& child : *nodes) {
+            // Painting a node paints over its children, so they are painted again on top
+            if (repaint) child->m_needs_paint = true;
+            if (child->m_needs_layout || child->m_needs_paint || child->m_child_dirty) {
+                child->update(engine);
+            }
+        }
+    }
+}
+
+void Container::remove(Widget& child) {
+    std::erase_if(m_children, [&](const std::unique_ptr<Widget>& node) { return node.get() == &child; });
+    invalidate_layout_of_children();
+}
+
+void Container::invalidate_layout_of_children() {
+    m_needs_layout = true;
+    invalidate_paint();
+}
+
+void Container::layout_children() {
+    const Rect area = content_rect();
+    const bool row = m_direction == Direction::ROW;
+    const int main_size = row ? area.width : area.height;
+
+    // Fixed children take their size first, the flexible ones share what is left
+    int fixed = 0;
+    int flex_total = 0;
+    for (auto& child : m_children) {
+        if (child->m_fixed_size >= 0) {
+            fixed += child->m_fixed_size;
+        } else {
+            flex_total += std::max(child->m_flex, 0);
+        }
+    }
+    const int free_space = std::max(main_size - fixed, 0);
+
+    int position = 0;
+    int flex_used = 0;
+    int free_used = 0;
+    for (auto& child : m_children) {
+        int size;
+        if (child->m_fixed_size >= 0) {
+            size = child->m_fixed_size;
+        } else if (flex_total > 0) {
+            // Cumulative rounding, so the flexible children fill the free space exactly
+            flex_used += std::max(child->m_flex, 0);
+            const int end = free_space * flex_used / flex_total;
+            size = end - free_used;
+            free_used = end;
+        } else {
+            size = 0;
+        }
+        size = std::clamp(size, 0, std::max(main_size - position, 0));
+        if (row) {
+            child->set_rect({area.x + position, area.y, size, area.height});
+        } else {
+            child->set_rect({area.x, area.y + position, area.width, size});
+        }
+        position += size;
+    }
+}
+
+Box::Box(std::string title, Direction direction) : Container(direction), m_title(std::move(title)) {
+    set_border(true);
+}
+
+Box& Box::set_title(std::string title) {
+    if (m_title != title) {
+        m_title = std::move(title);
+        invalidate_paint();
+    }
+    return *this;
+}
+
+void Box::paint_content(engine& engine, Rect) {
+    const Rect box = get_rect();
+    if (m_title.empty() || box.width <= 4) return;
+    const std::string_view title = utf8_prefix(m_title, box.width - 4);
+    engine.draw_text(box.x + 2, box.y, title, get_foreground(), get_background());
+}
+
+Text& Text::set_text(std::string text) {
+    if (m_text != text) {
+        m_text = std::move(text);
+        invalidate_paint();
+    }
+    return *this;
+}
+
+void Text::paint_content(engine& engine, Rect rect) {
+    std::string_view text = m_text;
+    for (int y = 0; y < rect.height && !text.empty(); y++) {
+        const size_t newline = text.find('\n');
+        const std::string_view line = text.substr(0, newline);
+        engine.draw_text(rect.x, rect.y + y, utf8_prefix(line, rect.width), get_foreground(), get_background());
+        text = newline == std::string_view::npos ? std::string_view() : text.substr(newline + 1);
+    }
+}
+
+void WidgetTree::render(engine& engine) {
+    const TerminalSize size = engine.get_terminal_size();
+    m_root.set_rect({0, 0, size.width, size.height});
+    m_root.update(engine);
+}
+
+}  // namespace TUIE
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Color.hpp"
+#include "Rect.hpp"
+
+namespace TUIE {
+
+class engine;
+
+// Retained widget tree. Every node keeps its layout and only lays out and paints again what was invalidated: changing
+// a text repaints that text, changing a size lays out its parent, and a terminal resize lays out everything. It relies
+// on the engine keeping the previous frame in the draw buffer, so the tree must not be cleared every frame.
+class Widget {
+   public:
+    virtual ~Widget() = default;
+
+   public:
+    // Size along the main axis of the parent: a fixed number of cells, or else a share of the free space proportional
+    // to the flex factor
+    Widget& set_fixed_size(int size);
+    Widget& set_flex(int flex);
+    Widget& set_border(bool border);
+    Widget& set_background(Color color);
+    Widget& set_foreground(Color color);
+    Rect get_rect() const { return m_rect; }
+
+   protected:
+    void invalidate_paint();
+    void invalidate_layout();
+    Rect content_rect() const;
+    Color get_background() const { return m_background; }
+    Color get_foreground() const { return m_foreground; }
+
+    virtual void layout_children() {}
+    virtual void paint_content(engine&, Rect) {}
+    virtual std::vector<std::unique_ptr<Widget>>* children() { return nullptr; }
+
+   private:
+    friend class Container;
+    friend class WidgetTree;
+
+    void set_rect(Rect rect);
+    void paint(engine& engine);
+    void update(engine& engine);
+    void mark_ancestors();
+
+   private:
+    Widget* m_parent = nullptr;
+    Rect m_rect = {0, 0, 0, 0};
+    int m_fixed_size = -1;
+    int m_flex = 1;
+    bool m_border = false;
+    Color m_background = TERMINAL_COLOR;
+    Color m_foreground = WHITE;
+
+    bool m_needs_layout = true;
+    bool m_needs_paint = true;
+    bool m_child_dirty = false;
+};
+
+enum class Direction { ROW, COLUMN };
+
+// Lays out its children one after the other along its direction
+class Container : public Widget {
+   public:
+    explicit Container(Direction direction) : m_direction(direction) {}
+
+   public:
+    template <typename T, typename... Args>
+    T& add(Args&&... args) {
+        auto child = std::make_unique<T>(std::forward<Args>(args)...);
+        T& ref = *child;
+        child->m_parent = this;
+        m_children.push_back(std::move(child));
+        invalidate_layout_of_children();
+        return ref;
+    }
+    void remove(Widget& child);
+
+   protected:
+    void layout_children() override;
+    std::vector<std::unique_ptr<Widget>>* children() override { return &m_children; }
+
+   private:
+    void invalidate_layout_of_children();
+
+   private:
+    Direction m_direction;
+    std::vector<std::unique_ptr<Widget>> m_children;
+};
+
+class Row : public Container {
+   public:
+    Row() : Container(Direction::ROW) {}
+};
+
+class Column : public Container {
+   public:
+    Column() : Container(Direction::COLUMN) {}
+};
+
+// Bordered column with an optional title on the top border
+class Box : public Container {
+   public:
+    explicit Box(std::string title = "", Direction direction = Direction::COLUMN);
+
+   public:
+    Box& set_title(std::string title);
+
+   protected:
+    void paint_content(engine& engine, Rect rect) override;
+
+   private:
+    std::string m_title;
+};
+
+// Text clipped to its rect, one row per line
+class Text : public Widget {
+   public:
+    explicit Text(std::string text = "") : m_text(std::move(text)) {}
+
+   public:
+    Text& set_text(std::string text);
+    const std::string& get_text() const { return m_text; }
+
+   protected:
+    void paint_content(engine& engine, Rect rect) override;
+
+   private:
+    std::string m_text;
+};
+
+// Root of a widget tree, it follows the terminal size
+class WidgetTree {
+   public:
+    explicit WidgetTree(Direction direction = Direction::COLUMN) : m_root(direction) {}
+
+   public:
+    Container& root() { return m_root; }
+    // Lays out and paints what changed since the previous call, call it once per frame between begin/end_draw
+    void render(engine& engine);
+
+   private:
+    Container m_root;
+};
+
+}  // namespace TUIE
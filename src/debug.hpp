@@ -1,28 +1,25 @@
 #pragma once
 
-#include <fstream>
 #include <functional>
 
-namespace TUIE {
-
-// Because is a TUI the debug messages can mess up the display, so its needs to go to a file instead of cerr
-class DebugStream {
-   public:
-    DebugStream() : file("debug.txt", std::ios::out | std::ios::trunc) {}
-    ~DebugStream() { file.close(); }
-    std::ofstream file;
+#include "Logger.hpp"
 
-    static DebugStream& instance() {
-        static DebugStream instance;
-        return instance;
-    }
-};
+namespace TUIE {
 
+// The messages are streamed, log_msg(LogCategory::INPUT, LogLevel::INFO, "Read " << n), into the asynchronous
+// logger (see Logger.hpp). Without DEBUG the macros compile to nothing, with it a disabled level costs one load.
 #ifdef DEBUG
-#define debug_msg(message) DebugStream::instance().file << message << std::endl;
+#define log_msg(category, level, message)                         \
+    do {                                                          \
+        if (::TUIE::Logger::is_enabled(category, level)) {        \
+            ::TUIE::LogMessage __log_message(category, level);    \
+            __log_message.stream() << message;                    \
+        }                                                         \
+    } while (0)
 #else
-#define debug_msg(message)
+#define log_msg(category, level, message)
 #endif
+#define debug_msg(message) log_msg(::TUIE::LogCategory::GENERAL, ::TUIE::LogLevel::INFO, message)
 
 template <typename T>
 struct __defer_impl {